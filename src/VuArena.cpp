@@ -0,0 +1,113 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuArena.h"
+#include <cstring>
+
+VuStringArena::VuStringArena(void)
+{
+  m_iUsed = 0;
+  m_iCapacity = 0;
+  m_iSize = 0;
+}
+
+VuStringArena::VuStringArena(VuStringArena &&other)
+  : m_blocks(std::move(other.m_blocks)), m_iUsed(other.m_iUsed), m_iCapacity(other.m_iCapacity), m_iSize(other.m_iSize)
+{
+  other.m_blocks.clear();
+  other.m_iUsed = 0;
+  other.m_iCapacity = 0;
+  other.m_iSize = 0;
+}
+
+VuStringArena &VuStringArena::operator=(VuStringArena &&other)
+{
+  if (this != &other)
+  {
+    m_blocks = std::move(other.m_blocks);
+    m_iUsed = other.m_iUsed;
+    m_iCapacity = other.m_iCapacity;
+    m_iSize = other.m_iSize;
+    other.m_blocks.clear();
+    other.m_iUsed = 0;
+    other.m_iCapacity = 0;
+    other.m_iSize = 0;
+  }
+  return *this;
+}
+
+VuStringRef VuStringArena::Add(const char *str, size_t iLength)
+{
+  if (iLength == 0)
+    return VuStringRef();
+
+  char *pDest;
+  size_t iNeeded = GetStoredSize(iLength);
+
+  if (m_iUsed + iNeeded > m_iCapacity && iNeeded > ARENA_BLOCK_SIZE / 4)
+  {
+    // keep the current block for the small strings that follow
+    std::unique_ptr<char[]> block(new char[iNeeded]);
+    pDest = block.get();
+    m_blocks.insert(m_blocks.empty() ? m_blocks.end() : m_blocks.end() - 1, std::move(block));
+    m_iSize += iNeeded;
+  }
+  else
+  {
+    if (m_iUsed + iNeeded > m_iCapacity)
+      AddBlock(ARENA_BLOCK_SIZE);
+    pDest = m_blocks.back().get() + m_iUsed;
+    m_iUsed += iNeeded;
+  }
+
+  memcpy(pDest, str, iLength);
+  pDest[iLength] = '\0';
+  return VuStringRef(pDest, iLength);
+}
+
+VuStringRef VuStringArena::Add(const char *str)
+{
+  return Add(str, strlen(str));
+}
+
+void VuStringArena::Reserve(size_t iSize)
+{
+  if (m_iUsed + iSize > m_iCapacity)
+    AddBlock(iSize);
+}
+
+void VuStringArena::AddBlock(size_t iSize)
+{
+  m_blocks.push_back(std::unique_ptr<char[]>(new char[iSize]));
+  m_iUsed = 0;
+  m_iCapacity = iSize;
+  m_iSize += iSize;
+}
+
+void VuStringArena::Clear(void)
+{
+  m_blocks.clear();
+  m_iUsed = 0;
+  m_iCapacity = 0;
+  m_iSize = 0;
+}
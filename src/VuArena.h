@@ -0,0 +1,114 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+
+// size of the blocks strings are packed into, longer strings get a block of their own
+#define ARENA_BLOCK_SIZE  (32 * 1024)
+
+/*
+ * A string stored in a VuStringArena. It does not own its characters and
+ * stays valid until the arena is cleared or destroyed. Moving the arena
+ * does not invalidate it.
+ */
+class VuStringRef
+{
+public:
+  VuStringRef(void) : m_str(""), m_iLength(0) {}
+  VuStringRef(const char *str, size_t iLength) : m_str(str), m_iLength(iLength) {}
+
+  const char *c_str(void) const { return m_str; }
+  size_t length(void) const { return m_iLength; }
+  bool empty(void) const { return m_iLength == 0; }
+
+private:
+  const char *m_str;
+  size_t m_iLength;
+};
+
+// hashing and comparison by content, for VuStringRef keys of hash maps
+struct VuStringRefHash
+{
+  size_t operator()(const VuStringRef &str) const
+  {
+    // 32 bit FNV-1a
+    unsigned int iHash = 2166136261u;
+    const unsigned char *p = (const unsigned char *)str.c_str();
+    for (size_t i = 0; i < str.length(); i++)
+    {
+      iHash ^= p[i];
+      iHash *= 16777619u;
+    }
+    return iHash;
+  }
+};
+
+struct VuStringRefEqual
+{
+  bool operator()(const VuStringRef &left, const VuStringRef &right) const
+  {
+    return left.length() == right.length() && memcmp(left.c_str(), right.c_str(), left.length()) == 0;
+  }
+};
+
+/*
+ * Packs the strings of one load or refresh of the webinterface data into
+ * a few large blocks, so that thousands of parsed records do not need a
+ * heap allocation per field and are released in bulk when the data they
+ * belong to is replaced.
+ */
+class VuStringArena
+{
+public:
+  VuStringArena(void);
+  VuStringArena(VuStringArena &&other);
+  VuStringArena &operator=(VuStringArena &&other);
+
+  VuStringRef Add(const char *str, size_t iLength);
+  VuStringRef Add(const char *str);
+  VuStringRef Add(const std::string &str) { return Add(str.c_str(), str.length()); }
+  // makes room for iSize bytes of strings in one block of exactly that size,
+  // for arenas that are filled once with strings of a known total length
+  void Reserve(size_t iSize);
+  void Clear(void);
+
+  // bytes a string of iLength takes in the arena
+  static size_t GetStoredSize(size_t iLength) { return iLength == 0 ? 0 : iLength + 1; }
+
+  size_t GetSize(void) const { return m_iSize; }
+
+private:
+  std::vector<std::unique_ptr<char[]> > m_blocks;
+  size_t m_iUsed;  // bytes used in the last block
+  size_t m_iCapacity;  // size of the last block
+  size_t m_iSize;  // bytes allocated by all blocks
+
+  void AddBlock(size_t iSize);
+
+  VuStringArena(const VuStringArena &);
+  VuStringArena &operator=(const VuStringArena &);
+};
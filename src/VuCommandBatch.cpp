@@ -0,0 +1,87 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuCommandBatch.h"
+
+using namespace PLATFORM;
+
+VuCommandBatch::VuCommandBatch(std::vector<VuCommand> &commands, const Sender &send) :
+  m_commands(commands),
+  m_send(send)
+{
+  m_iNext = 0;
+  m_iFailed = 0;
+}
+
+unsigned int VuCommandBatch::Run(unsigned int iWorkers)
+{
+  std::vector<VuCommandWorker*> workers;
+  for (unsigned int i = 1; i < iWorkers && i < m_commands.size(); i++)
+  {
+    VuCommandWorker *worker = new VuCommandWorker(*this);
+    if (worker->CreateThread())
+      workers.push_back(worker);
+    else
+      delete worker;
+  }
+
+  SendPending();
+
+  for (unsigned int i = 0; i < workers.size(); i++)
+  {
+    // waits for the worker to finish its last command
+    workers[i]->StopThread(0);
+    delete workers[i];
+  }
+
+  return m_iFailed;
+}
+
+void VuCommandBatch::SendPending(void)
+{
+  while (true)
+  {
+    unsigned int iCommand;
+    {
+      CLockObject lock(m_mutex);
+      if (m_iNext >= m_commands.size())
+        return;
+      iCommand = m_iNext++;
+    }
+
+    VuCommand &command = m_commands[iCommand];
+    command.bOk = m_send(command);
+
+    if (!command.bOk)
+    {
+      CLockObject lock(m_mutex);
+      m_iFailed++;
+    }
+  }
+}
+
+void *VuCommandBatch::VuCommandWorker::Process(void)
+{
+  m_batch.SendPending();
+  return NULL;
+}
@@ -0,0 +1,79 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "platform/threads/threads.h"
+#include "platform/util/StdString.h"
+
+struct VuCommand
+{
+  std::string strCommand; // webinterface path and query, relative to the base URL
+  bool bOk;
+  CStdString strResult; // e2statetext of the receiver
+
+  VuCommand(const std::string &command)
+  {
+    strCommand = command;
+    bOk = false;
+  }
+};
+
+/*
+ * Sends a list of webinterface commands (timerdelete, timerchange,
+ * moviedelete, ...) with several of them in flight at once, instead of
+ * one blocking round trip after the other. The calling thread sends
+ * commands as well and returns once every command has its result.
+ */
+class VuCommandBatch
+{
+public:
+  typedef std::function<bool(VuCommand&)> Sender;
+
+  VuCommandBatch(std::vector<VuCommand> &commands, const Sender &send);
+
+  // returns the number of failed commands
+  unsigned int Run(unsigned int iWorkers);
+
+private:
+  class VuCommandWorker : public PLATFORM::CThread
+  {
+  public:
+    VuCommandWorker(VuCommandBatch &batch) : m_batch(batch) {}
+
+  protected:
+    virtual void *Process(void);
+
+  private:
+    VuCommandBatch &m_batch;
+  };
+
+  std::vector<VuCommand> &m_commands;
+  Sender m_send;
+  PLATFORM::CMutex m_mutex;
+  unsigned int m_iNext;
+  unsigned int m_iFailed;
+
+  void SendPending(void);
+};
@@ -25,15 +25,63 @@
 #include <iostream> 
 #include <fstream> 
 #include <string>
+#include <algorithm>
 #include "kodi/util/XMLUtils.h"
+#include "platform/util/timeutils.h"
+#include "VuDataSchema.h"
 
 
 using namespace ADDON;
 using namespace PLATFORM;
 
-bool CCurlFile::Get(const std::string &strURL, std::string &strResult)
+// the JSON keys are those of the OpenWebif api
+
+const VuXMLField<VuService> ServiceFields[] =
+{
+  VU_XML_FIELD("e2servicereference", "servicereference", true, [](VuService &r, const char *v) { r.strServiceReference = v; }),
+  VU_XML_FIELD("e2servicename",      "servicename",      true, [](VuService &r, const char *v) { r.strServiceName = v; })
+};
+
+const VuXMLField<VuEPGRow> EPGFields[] =
+{
+  VU_XML_FIELD("e2eventid",                  "id",              true,  [](VuEPGRow &r, const char *v) { r.entry.iEventId = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2eventstart",               "begin_timestamp", true,  [](VuEPGRow &r, const char *v) { r.entry.startTime = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2eventduration",            "duration_sec",    true,  [](VuEPGRow &r, const char *v) { r.iDuration = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2eventtitle",               "title",           true,  [](VuEPGRow &r, const char *v) { r.entry.strTitle = r.strings->Add(v); }),
+  VU_XML_FIELD("e2eventdescription",         "shortdesc",       false, [](VuEPGRow &r, const char *v) { r.entry.strPlotOutline = r.strings->Add(v); }),
+  VU_XML_FIELD("e2eventdescriptionextended", "longdesc",        false, [](VuEPGRow &r, const char *v) { r.entry.strPlot = r.strings->Add(v); }),
+  VU_XML_FIELD("e2eventservicereference",    "sref",            false, [](VuEPGRow &r, const char *v) { r.entry.iServiceRef = r.serviceRefs->Intern(v); })
+};
+
+const VuXMLField<VuTimerRow> TimerFields[] =
+{
+  VU_XML_FIELD("e2name",             "name",        false, [](VuTimerRow &r, const char *v) { r.timer.strTitle = v; }),
+  VU_XML_FIELD("e2description",      "description", false, [](VuTimerRow &r, const char *v) { r.timer.strPlot = v; }),
+  VU_XML_FIELD("e2servicereference", "serviceref",  false, [](VuTimerRow &r, const char *v) { r.timer.iServiceRef = r.serviceRefs->Intern(v); }),
+  VU_XML_FIELD("e2timebegin",        "begin",       true,  [](VuTimerRow &r, const char *v) { r.timer.startTime = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2timeend",          "end",         true,  [](VuTimerRow &r, const char *v) { r.timer.endTime = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2repeated",         "repeated",    false, [](VuTimerRow &r, const char *v) { r.timer.iWeekdays = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2eit",              "eit",         false, [](VuTimerRow &r, const char *v) { r.timer.iEpgID = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2state",            "state",       true,  [](VuTimerRow &r, const char *v) { r.iState = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2disabled",         "disabled",    true,  [](VuTimerRow &r, const char *v) { r.iDisabled = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2cancled",          "cancelled",   false, [](VuTimerRow &r, const char *v) { r.bCancelled = VuXMLToBool(v); })
+};
+
+const VuXMLField<VuRecordingRow> RecordingFields[] =
+{
+  VU_XML_FIELD("e2servicereference",     "serviceref",          false, [](VuRecordingRow &r, const char *v) { r.recording.strRecordingId = r.strings->Add(v); }),
+  VU_XML_FIELD("e2title",                "eventname",           false, [](VuRecordingRow &r, const char *v) { r.recording.strTitle = r.strings->Add(v); }),
+  VU_XML_FIELD("e2description",          "description",         false, [](VuRecordingRow &r, const char *v) { r.recording.strPlotOutline = r.strings->Add(v); }),
+  VU_XML_FIELD("e2descriptionextended",  "descriptionExtended", false, [](VuRecordingRow &r, const char *v) { r.recording.strPlot = r.strings->Add(v); }),
+  VU_XML_FIELD("e2servicename",          "servicename",         false, [](VuRecordingRow &r, const char *v) { r.recording.strChannelName = r.strings->Add(v); }),
+  VU_XML_FIELD("e2time",                 "recordingtime",       false, [](VuRecordingRow &r, const char *v) { r.recording.startTime = VuXMLToInt(v); }),
+  VU_XML_FIELD("e2length",               "length",              false, [](VuRecordingRow &r, const char *v) { r.strLength = v; }),
+  VU_XML_FIELD("e2filename",             "filename",            false, [](VuRecordingRow &r, const char *v) { r.strFilename = v; })
+};
+
+bool CCurlFile::Get(const char *strURL, std::string &strResult)
 {
-  void* fileHandle = XBMC->OpenFile(strURL.c_str(), 0);
+  void* fileHandle = XBMC->OpenFile(strURL, 0);
   if (fileHandle)
   {
     char buffer[1024];
@@ -63,7 +111,7 @@ bool Vu::LoadLocations()
     url.Format("%s%s",  m_strURL.c_str(), "web/getlocations"); 
  
   CStdString strXML;
-  strXML = GetHttpXML(url);
+  strXML = GetHttpXML(url.c_str());
 
   int iNumLocations = 0;
 
@@ -101,7 +149,7 @@ bool Vu::LoadLocations()
     CStdString strTmp;
     strTmp = pNode->GetText();
 
-    m_locations.push_back(strTmp);
+    m_recordingLocations.push_back(std::unique_ptr<VuRecordingLocation>(new VuRecordingLocation(strTmp)));
     iNumLocations++;
 
     XBMC->Log(LOG_DEBUG, "%s Added '%s' as a recording location", __FUNCTION__, strTmp.c_str());
@@ -112,13 +160,24 @@ bool Vu::LoadLocations()
   return true;
 }
 
-void Vu::TimerUpdates()
+bool Vu::TimerUpdates(VU_REQUEST_PRIORITY priority)
 {
-  std::vector<VuTimer> newtimer = LoadTimers();
+  // the receiver is asked without holding m_mutex, so Kodi's calls don't wait for it
+  std::vector<VuTimer> newtimer;
+  if (!LoadTimers(newtimer, priority))
+  {
+    // an unreadable answer says nothing about the timers, the known ones are kept
+    XBMC->Log(LOG_ERROR, "%s Could not load the timers, keeping the known ones", __FUNCTION__);
+    return false;
+  }
 
-  for (unsigned int i=0; i<m_timers.size(); i++)
+  CLockObject lock(m_mutex);
+  std::vector<unsigned int> clientIndexes;
+  m_timers.GetClientIndexes(clientIndexes);
+
+  for (unsigned int i=0; i<clientIndexes.size(); i++)
   {
-    m_timers[i].iUpdateState = VU_UPDATE_STATE_NONE;
+    m_timers.Get(clientIndexes[i])->iUpdateState = VU_UPDATE_STATE_NONE;
   }
 
   unsigned int iUpdated=0;
@@ -126,28 +185,33 @@ void Vu::TimerUpdates()
 
   for (unsigned int j=0;j<newtimer.size(); j++) 
   {
-    for (unsigned int i=0; i<m_timers.size(); i++) 
+    for (unsigned int i=0; i<clientIndexes.size(); i++) 
     {
-      if (m_timers[i].like(newtimer[j]))
+      VuTimer &timer = *m_timers.Get(clientIndexes[i]);
+      if (timer.like(newtimer[j]))
       {
-        if(m_timers[i] == newtimer[j])
+        if(timer == newtimer[j])
         {
-          m_timers[i].iUpdateState = VU_UPDATE_STATE_FOUND;
+          timer.iUpdateState = VU_UPDATE_STATE_FOUND;
           newtimer[j].iUpdateState = VU_UPDATE_STATE_FOUND;
           iUnchanged++;
         }
         else
         {
+          VuTimer updated = timer;
           newtimer[j].iUpdateState = VU_UPDATE_STATE_UPDATED;
-          m_timers[i].iUpdateState = VU_UPDATE_STATE_UPDATED;
-          m_timers[i].strTitle = newtimer[j].strTitle;
-          m_timers[i].strPlot = newtimer[j].strPlot;
-          m_timers[i].iChannelId = newtimer[j].iChannelId;
-          m_timers[i].startTime = newtimer[j].startTime;
-          m_timers[i].endTime = newtimer[j].endTime;
-          m_timers[i].bRepeating = newtimer[j].bRepeating;
-          m_timers[i].iWeekdays = newtimer[j].iWeekdays;
-          m_timers[i].iEpgID = newtimer[j].iEpgID;
+          updated.iUpdateState = VU_UPDATE_STATE_UPDATED;
+          updated.strTitle = newtimer[j].strTitle;
+          updated.strPlot = newtimer[j].strPlot;
+          updated.iChannelId = newtimer[j].iChannelId;
+          updated.iServiceRef = newtimer[j].iServiceRef;
+          updated.startTime = newtimer[j].startTime;
+          updated.endTime = newtimer[j].endTime;
+          updated.bRepeating = newtimer[j].bRepeating;
+          updated.iWeekdays = newtimer[j].iWeekdays;
+          updated.iEpgID = newtimer[j].iEpgID;
+          updated.state = newtimer[j].state;
+          m_timers.Update(clientIndexes[i], updated);
 
           iUpdated++;
         }
@@ -157,13 +221,13 @@ void Vu::TimerUpdates()
 
   unsigned int iRemoved = 0;
 
-  for (unsigned int i=0; i<m_timers.size(); i++)
+  for (unsigned int i=0; i<clientIndexes.size(); i++)
   {
-    if (m_timers.at(i).iUpdateState == VU_UPDATE_STATE_NONE)
+    const VuTimer &timer = *m_timers.Get(clientIndexes[i]);
+    if (timer.iUpdateState == VU_UPDATE_STATE_NONE)
     {
-      XBMC->Log(LOG_INFO, "%s Removed timer: '%s', ClientIndex: '%d'", __FUNCTION__, m_timers.at(i).strTitle.c_str(), m_timers.at(i).iClientIndex);
-      m_timers.erase(m_timers.begin()+i);
-      i=0;
+      XBMC->Log(LOG_INFO, "%s Removed timer: '%s', ClientIndex: '%d'", __FUNCTION__, timer.strTitle.c_str(), timer.iClientIndex);
+      m_timers.Remove(clientIndexes[i]);
       iRemoved++;
     }
   }
@@ -174,21 +238,53 @@ void Vu::TimerUpdates()
     if(newtimer.at(i).iUpdateState == VU_UPDATE_STATE_NEW)
     {  
       VuTimer &timer = newtimer.at(i);
-      timer.iClientIndex = m_iClientIndexCounter;
-      XBMC->Log(LOG_INFO, "%s New timer: '%s', ClientIndex: '%d'", __FUNCTION__, timer.strTitle.c_str(), m_iClientIndexCounter);
-      m_timers.push_back(timer);
-      m_iClientIndexCounter++;
+      unsigned int iClientIndex = m_timers.Add(timer);
+      XBMC->Log(LOG_INFO, "%s New timer: '%s', ClientIndex: '%d'", __FUNCTION__, timer.strTitle.c_str(), iClientIndex);
       iNew++;
     } 
   }
  
   XBMC->Log(LOG_INFO, "%s No of timers: removed [%d], untouched [%d], updated '%d', new '%d'", __FUNCTION__, iRemoved, iUnchanged, iUpdated, iNew); 
 
+  UpdateTimerBoundaries();
+
   if (iRemoved != 0 || iUpdated != 0 || iNew != 0) 
   {
     XBMC->Log(LOG_INFO, "%s Changes in timerlist detected, trigger an update!", __FUNCTION__);
     PVR->TriggerTimerUpdate();
   }
+
+  return true;
+}
+
+void Vu::UpdateTimerBoundaries()
+{
+  // the update thread reloads the timers right after the next start or end of one
+  time_t now = time(NULL);
+  m_timerBoundaries.Clear();
+  m_timers.ForEach([this, now](const VuTimer &timer)
+  {
+    if (timer.state == PVR_TIMER_STATE_CANCELLED || timer.state == PVR_TIMER_STATE_ABORTED)
+      return;
+
+    if (timer.startTime > now && timer.state != PVR_TIMER_STATE_RECORDING)
+      m_timerBoundaries.Add(timer.startTime + TIMER_BOUNDARY_DELAY, false);
+    if (timer.endTime > now)
+      m_timerBoundaries.Add(timer.endTime + TIMER_BOUNDARY_DELAY, true);
+  });
+}
+
+void Vu::TimerEdited(bool bRecordingsChanged)
+{
+  // the receiver confirmed the edit and m_timers already reflects it, one
+  // reload after the last of a series of edits catches anything the box did differently
+  time_t now = time(NULL);
+  m_timerReconcile.Request(now, RECONCILE_DELAY);
+  if (bRecordingsChanged)
+    m_recordingReconcile.Request(now, RECONCILE_DELAY);
+
+  UpdateTimerBoundaries();
+  PVR->TriggerTimerUpdate();
 }
 
 Vu::Vu() 
@@ -211,12 +307,12 @@ Vu::Vu()
   m_strURL = strURL.c_str();
 
   m_iNumRecordings = 0;
+  m_bRecordingsLoaded = false;
+  m_bUseJSON = false;
   m_iNumChannelGroups = 0;
   m_iCurrentChannel = -1;
-  m_iClientIndexCounter = 1;
 
   m_bUpdating = false;
-  m_iUpdateTimer = 0;
   m_bInitialEPG = true;
 
   std::string initialEPGReady = "special://userdata/addon_data/pvr.vuplus/initialEPGReady";
@@ -306,38 +402,49 @@ void  *Vu::Process()
     }
   }
 
-  // Trigger "Real" EPG updates 
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_channels.size(); iChannelPtr++)
-  {
-    XBMC->Log(LOG_DEBUG, "%s - Trigger EPG update for channel '%d'", __FUNCTION__, iChannelPtr);
-    PVR->TriggerEpgUpdate(m_channels.at(iChannelPtr).iUniqueId);
-  }
+  // "Real" EPG updates are triggered by the EPG refresh task, one channel at a time.
+  // Timer state changes are picked up at the timer boundaries, so timers and
+  // recordings are only polled now and then for changes made elsewhere.
+  unsigned int iUpdateInterval = g_iUpdateInterval * 60;
+  unsigned int iPollInterval = iUpdateInterval * TIMER_POLL_FACTOR;
+
+  VuScheduler scheduler;
+  scheduler.SetRateLimit(SCHEDULER_RUNS_PER_MINUTE, SCHEDULER_BURST);
+  scheduler.AddTask("timers", VU_TASK_PRIORITY_NORMAL, iPollInterval, 10, [this]() { return UpdateTimersTask(); });
+  scheduler.AddTask("recordings", VU_TASK_PRIORITY_NORMAL, iPollInterval, 10, [this]() { return UpdateRecordingsTask(); });
+  if (g_bAutomaticTimerlistCleanup)
+    scheduler.AddTask("timercleanup", VU_TASK_PRIORITY_LOW, iUpdateInterval, 30, [this]() { return CleanupTimersTask(); });
+  scheduler.AddTask("epg", VU_TASK_PRIORITY_LOW, 0, 0, [this]() { return RefreshNextEPG(); });
+  scheduler.AddTask("memory", VU_TASK_PRIORITY_LOW, MEMORY_REPORT_INTERVAL, 60, [this]()
+  {
+    VuMemoryUsage usage;
+    GetMemoryUsage(usage);
+    LogMemoryUsage(LOG_DEBUG, usage);
+    return VU_TASK_IDLE;
+  });
+  if (g_iEPGHotWindow > 0)
+    scheduler.AddTask("epgpromote", VU_TASK_PRIORITY_LOW, EPG_PROMOTE_INTERVAL, 60, [this]() { return PromoteEPGTask(); });
 
   while(!IsStopped())
   {
-    Sleep(5 * 1000);
-    m_iUpdateTimer += 5;
+    Sleep(SCHEDULER_TICK);
 
-    if ((int)m_iUpdateTimer > (g_iUpdateInterval * 60)) 
+    time_t now = time(NULL);
+    bool bEnd;
+    while (m_timerBoundaries.PopDue(now, bEnd))
     {
-      m_iUpdateTimer = 0;
- 
-      // Trigger Timer and Recording updates acording to the addon settings
-      CLockObject lock(m_mutex);
-      XBMC->Log(LOG_INFO, "%s Perform Updates!", __FUNCTION__);
-
-      if (g_bAutomaticTimerlistCleanup) 
-      {
-        CStdString strTmp;
-        strTmp.Format("web/timercleanup?cleanup=true");
-        CStdString strResult;
-        if(!SendSimpleCommand(strTmp, strResult))
-          XBMC->Log(LOG_ERROR, "%s - AutomaticTimerlistCleanup failed!", __FUNCTION__);
-      }
-      TimerUpdates();
-      PVR->TriggerRecordingUpdate();
+      scheduler.RunSoon("timers", now);
+      // a finished timer leaves a new recording behind
+      if (bEnd)
+        scheduler.RunSoon("recordings", now);
     }
 
+    if (m_timerReconcile.PopDue(now))
+      scheduler.RunSoon("timers", now);
+    if (m_recordingReconcile.PopDue(now))
+      scheduler.RunSoon("recordings", now);
+
+    scheduler.RunPendingTask(now);
   }
 
   //CLockObject lock(m_mutex);
@@ -346,34 +453,94 @@ void  *Vu::Process()
   return NULL;
 }
 
+VU_TASK_RESULT Vu::UpdateTimersTask()
+{
+  XBMC->Log(LOG_INFO, "%s Perform timer update!", __FUNCTION__);
+
+  // a failed fetch is retried with backoff instead of waiting for the next poll
+  return TimerUpdates(VU_REQUEST_BACKGROUND) ? VU_TASK_DONE : VU_TASK_FAILED;
+}
+
+VU_TASK_RESULT Vu::UpdateRecordingsTask()
+{
+  XBMC->Log(LOG_INFO, "%s Perform recording update!", __FUNCTION__);
+
+  // Kodi only has to fetch the recordings again if a movielist changed
+  bool bChanged;
+  bool bAllLoaded = RefreshRecordings(VU_REQUEST_BACKGROUND, bChanged);
+  if (bChanged)
+  {
+    XBMC->Log(LOG_INFO, "%s Changes in recordings detected, trigger an update!", __FUNCTION__);
+    PVR->TriggerRecordingUpdate();
+  }
+
+  // a location that could not be loaded is retried soon
+  return bAllLoaded ? VU_TASK_DONE : VU_TASK_FAILED;
+}
+
+VU_TASK_RESULT Vu::CleanupTimersTask()
+{
+  CLockObject lock(m_mutex);
+  CStdString strTmp;
+  strTmp.Format("web/timercleanup?cleanup=true");
+  CStdString strResult;
+  if(!SendSimpleCommand(strTmp.c_str(), strResult, false, VU_REQUEST_BACKGROUND))
+  {
+    XBMC->Log(LOG_ERROR, "%s - AutomaticTimerlistCleanup failed!", __FUNCTION__);
+    return VU_TASK_FAILED;
+  }
+
+  return VU_TASK_DONE;
+}
+
 bool Vu::LoadChannels() 
 {    
   bool bOk = false;
 
   m_channels.clear();
+  m_channelTags.clear();
+  m_channelIndex.clear();
   // Load Channels
   for (int i = 0;i<m_iNumChannelGroups;  i++) 
   {
     VuChannelGroup &myGroup = m_groups.at(i);
-    if (LoadChannels(myGroup.strServiceReference, myGroup.strGroupName))
+    myGroup.members.clear();
+    if (LoadChannels(myGroup))
       bOk = true;
   }
 
   // Load the radio channels - continue if no channels are found 
-  CStdString strTmp;
-  strTmp.Format("1:7:1:0:0:0:0:0:0:0:FROM BOUQUET \"userbouquet.favourites.radio\" ORDER BY bouquet");
-  LoadChannels(strTmp, "radio");
+  VuChannelGroup radioGroup;
+  radioGroup.strServiceReference = "1:7:1:0:0:0:0:0:0:0:FROM BOUQUET \"userbouquet.favourites.radio\" ORDER BY bouquet";
+  radioGroup.strGroupName = "radio";
+  LoadChannels(radioGroup);
+
+  CLockObject lock(m_epgMutex);
+  m_epg.clear();
+  m_epg.resize(m_channels.size());
+  m_descriptionLRU.Reset(m_channels.size());
+  m_epgLRU.Reset(m_channels.size());
+  m_epgRetry.assign(m_channels.size(), 0);
+  if (g_iEPGHotWindow > 0)
+    m_coldEPG.Open("special://userdata/addon_data/pvr.vuplus/", m_channels.size());
 
   return bOk;
 }
 
-bool Vu::LoadChannelGroups() 
+bool Vu::LoadServices(const std::string &strBouquet, std::vector<VuService> &services)
 {
+  const char *strPath = m_bUseJSON ? "api/getservices" : "web/getservices";
+
   CStdString strTmp; 
+  if (strBouquet.empty())
+    strTmp.Format("%s%s", m_strURL.c_str(), strPath);
+  else
+    strTmp.Format("%s%s?sRef=%s", m_strURL.c_str(), strPath, URLEncodeInline(strBouquet.c_str()));
 
-  strTmp.Format("%sweb/getservices", m_strURL.c_str());
+  CStdString strXML = GetHttpXML(strTmp.c_str());  
 
-  CStdString strXML = GetHttpXML(strTmp);  
+  if (m_bUseJSON)
+    return ParseServicesJSON(strXML, services);
 
   TiXmlDocument xmlDoc;
   if (!xmlDoc.Parse(strXML.c_str()))
@@ -404,33 +571,46 @@ bool Vu::LoadChannelGroups()
     return false;
   }
 
-  m_groups.clear();
-  m_iNumChannelGroups = 0;
-
   for (; pNode != NULL; pNode = pNode->NextSiblingElement("e2service"))
   {
-    CStdString strTmp;
+    VuService service;
 
-    if (!XMLUtils::GetString(pNode, "e2servicereference", strTmp))
+    if (!VuXMLRead(pNode, ServiceFields, service))
       continue;
     
     // Check whether the current element is not just a label
-    if (strTmp.compare(0,5,"1:64:") == 0)
+    VuServiceRef ref;
+    if (VuServiceRef::Parse(service.strServiceReference, ref) && ref.IsMarker())
       continue;
 
-    VuChannelGroup newGroup;
-    newGroup.strServiceReference = strTmp;
+    services.push_back(service);
+  }
 
-    if (!XMLUtils::GetString(pNode, "e2servicename", strTmp)) 
-      continue;
+  return true;
+}
+
+bool Vu::LoadChannelGroups() 
+{
+  std::vector<VuService> services;
+  if (!LoadServices("", services))
+    return false;
+
+  m_groups.clear();
+  m_groupIndex.clear();
+  m_iNumChannelGroups = 0;
 
-    newGroup.strGroupName = strTmp;
+  for (unsigned int i = 0; i < services.size(); i++)
+  {
+    VuChannelGroup newGroup;
+    newGroup.strServiceReference = services[i].strServiceReference;
+    newGroup.strGroupName = services[i].strServiceName;
 
-    if (g_bOnlyOneGroup && g_strOneGroup.compare(strTmp.c_str())) {
-        XBMC->Log(LOG_INFO, "%s Only one group is set, but current e2servicename '%s' does not match requested name '%s'", __FUNCTION__, strTmp.c_str(), g_strOneGroup.c_str());
+    if (g_bOnlyOneGroup && g_strOneGroup.compare(newGroup.strGroupName)) {
+        XBMC->Log(LOG_INFO, "%s Only one group is set, but current e2servicename '%s' does not match requested name '%s'", __FUNCTION__, newGroup.strGroupName.c_str(), g_strOneGroup.c_str());
         continue;
     }
  
+    m_groupIndex[newGroup.strGroupName] = m_groups.size();
     m_groups.push_back(newGroup);
 
     XBMC->Log(LOG_INFO, "%s Loaded channelgroup: %s", __FUNCTION__, newGroup.strGroupName.c_str());
@@ -441,103 +621,58 @@ bool Vu::LoadChannelGroups()
   return true;
 }
 
-bool Vu::LoadChannels(CStdString strServiceReference, CStdString strGroupName) 
+bool Vu::LoadChannels(VuChannelGroup &group) 
 {
-  XBMC->Log(LOG_INFO, "%s loading channel group: '%s'", __FUNCTION__, strGroupName.c_str());
-
-  CStdString strTmp;
-  strTmp.Format("%sweb/getservices?sRef=%s", m_strURL.c_str(), URLEncodeInline(strServiceReference.c_str()));
+  XBMC->Log(LOG_INFO, "%s loading channel group: '%s'", __FUNCTION__, group.strGroupName.c_str());
 
-  CStdString strXML = GetHttpXML(strTmp);  
-  
-  TiXmlDocument xmlDoc;
-  if (!xmlDoc.Parse(strXML.c_str()))
-  {
-    XBMC->Log(LOG_DEBUG, "Unable to parse XML: %s at line %d", xmlDoc.ErrorDesc(), xmlDoc.ErrorRow());
-    return false;
-  }
-
-  TiXmlHandle hDoc(&xmlDoc);
-  TiXmlElement* pElem;
-  TiXmlHandle hRoot(0);
-
-  pElem = hDoc.FirstChildElement("e2servicelist").Element();
-
-  if (!pElem)
-  {
-    XBMC->Log(LOG_DEBUG, "%s Could not find <e2servicelist> element!", __FUNCTION__);
+  std::vector<VuService> services;
+  if (!LoadServices(group.strServiceReference, services))
     return false;
-  }
-
-  hRoot=TiXmlHandle(pElem);
 
-  TiXmlElement* pNode = hRoot.FirstChildElement("e2service").Element();
-
-  if (!pNode)
-  {
-    XBMC->Log(LOG_DEBUG, "Could not find <e2service> element");
-    return false;
-  }
-  
   bool bRadio;
 
-  bRadio = !strGroupName.compare("radio");
+  bRadio = !group.strGroupName.compare("radio");
 
-  for (; pNode != NULL; pNode = pNode->NextSiblingElement("e2service"))
+  for (unsigned int i = 0; i < services.size(); i++)
   {
-    CStdString strTmp;
+    CStdString strTmp = services[i].strServiceReference;
+    unsigned int iServiceRef = m_serviceRefs.Intern(services[i].strServiceReference);
 
-    if (!XMLUtils::GetString(pNode, "e2servicereference", strTmp))
-      continue;
-    
-    // Check whether the current element is not just a label
-    if (strTmp.compare(0,5,"1:64:") == 0)
+    // The same service can be part of several bouquets, only reference it
+    int iExisting = GetChannelNumberById(iServiceRef);
+    if (iExisting > 0)
+    {
+      group.members.push_back(iExisting-1);
+      XBMC->Log(LOG_DEBUG, "%s Channel '%s' already loaded, added to group '%s'", __FUNCTION__, m_channels.at(iExisting-1).strChannelName.c_str(), group.strGroupName.c_str());
       continue;
+    }
 
     VuChannel newChannel;
     newChannel.bRadio = bRadio;
     newChannel.bInitialEPG = true;
-    newChannel.strGroupName = strGroupName;
+    newChannel.strGroupName = group.strGroupName;
     newChannel.iUniqueId = m_channels.size()+1;
     newChannel.iChannelNumber = m_channels.size()+1;
     newChannel.strServiceReference = strTmp;
-
-    if (!XMLUtils::GetString(pNode, "e2servicename", strTmp)) 
-      continue;
-
-    newChannel.strChannelName = strTmp;
+    newChannel.iServiceRef = iServiceRef;
+    newChannel.strEncodedServiceReference = URLEncodeInline(newChannel.strServiceReference.c_str());
+    newChannel.strChannelName = services[i].strServiceName;
  
-    std::string strIcon;
-    strIcon = newChannel.strServiceReference.c_str();
-
-    int j = 0;
-    std::string::iterator it = strIcon.begin();
-
-    while (j<10 && it != strIcon.end())
+    // picons and the stream path use the ten numeric fields of the reference
+    char strId[SERVICE_REF_ID_SIZE];
+    char strPicon[SERVICE_REF_ID_SIZE];
+    VuServiceRef ref;
+    if (VuServiceRef::Parse(newChannel.strServiceReference, ref))
     {
-      if (*it == ':')
-        j++;
-
-      it++;
+      ref.FormatId(strId, ':');
+      ref.FormatId(strPicon, '_');
     }
-    std::string::size_type index = it-strIcon.begin();
-
-    strIcon = strIcon.substr(0,index);
-
-    it = strIcon.end() - 1;
-    if (*it == ':')
+    else
     {
-      strIcon.erase(it);
+      snprintf(strId, sizeof(strId), "%s", newChannel.strServiceReference.c_str());
+      snprintf(strPicon, sizeof(strPicon), "%s", newChannel.strServiceReference.c_str());
+      std::replace(strPicon, strPicon + strlen(strPicon), ':', '_');
     }
-    
-    CStdString strTmp2;
-
-    strTmp2.Format("%s", strIcon.c_str());
-
-    std::replace(strIcon.begin(), strIcon.end(), ':', '_');
-    strIcon = g_strIconPath.c_str() + strIcon + ".png";
-
-    newChannel.strIconPath = strIcon;
 
     strTmp.Format("");
 
@@ -545,24 +680,28 @@ bool Vu::LoadChannels(CStdString strServiceReference, CStdString strGroupName)
       strTmp.Format("%s:%s@", g_strUsername.c_str(), g_strPassword.c_str());
     
     if (!g_bUseSecureHTTP)
-      strTmp.Format("http://%s%s:%d/%s", strTmp.c_str(), g_strHostname, g_iPortStream, strTmp2.c_str());
+      strTmp.Format("http://%s%s:%d/%s", strTmp.c_str(), g_strHostname, g_iPortStream, strId);
     else
-      strTmp.Format("https://%s%s:%d/%s", strTmp.c_str(), g_strHostname, g_iPortStream, strTmp2.c_str());
+      strTmp.Format("https://%s%s:%d/%s", strTmp.c_str(), g_strHostname, g_iPortStream, strId);
     
     newChannel.strStreamURL = strTmp;
 
     if (g_bOnlinePicons == true)
-    {
-      std::replace(strTmp2.begin(), strTmp2.end(), ':', '_');
-      strTmp.Format("%spicon/%s.png", m_strURL.c_str(), strTmp2.c_str());
-      newChannel.strIconPath = strTmp;
-    }
+      strTmp.Format("%spicon/%s.png", m_strURL.c_str(), strPicon);
+    else
+      strTmp.Format("%s%s.png", g_strIconPath.c_str(), strPicon);
 
+    newChannel.strIconPath = strTmp;
+
+    if (m_channelIndex.size() <= iServiceRef)
+      m_channelIndex.resize(iServiceRef + 1, 0);
+    m_channelIndex[iServiceRef] = m_channels.size() + 1;
+    group.members.push_back(m_channels.size());
     m_channels.push_back(newChannel);
     XBMC->Log(LOG_INFO, "%s Loaded channel: %s, Icon: %s", __FUNCTION__, newChannel.strChannelName.c_str(), newChannel.strIconPath.c_str());
   }
 
-  XBMC->Log(LOG_INFO, "%s Loaded %d Channels", __FUNCTION__, m_channels.size());
+  XBMC->Log(LOG_INFO, "%s Loaded %d Channels, %d in group '%s'", __FUNCTION__, m_channels.size(), group.members.size(), group.strGroupName.c_str());
   return true;
 }
 
@@ -571,25 +710,49 @@ bool Vu::IsConnected()
   return m_bIsConnected;
 }
 
-CStdString Vu::GetHttpXML(CStdString& url) 
+CStdString Vu::GetHttpXML(const char *url, VU_REQUEST_PRIORITY priority) 
 {
 //  CLockObject lock(m_mutex);
 
-  XBMC->Log(LOG_INFO, "%s Open webAPI with URL: '%s'", __FUNCTION__, url.c_str());
+  std::string strTmp;
+  bool bOk = false;
 
-  CStdString strTmp;
+  // identical requests already in flight or just answered are shared
+  if (m_responseCache.Begin(url, g_iRequestCacheTTL * 1000, strTmp, bOk))
+  {
+    bOk = FetchURL(url, strTmp, priority);
+    m_responseCache.Finish(url, strTmp, bOk);
+  }
+  else
+    XBMC->Log(LOG_DEBUG, "%s Shared result for URL: '%s'", __FUNCTION__, url);
+
+  if (!bOk)
+    return "";
+
+  return strTmp;
+}
+
+bool Vu::FetchURL(const char *url, std::string& strResult, VU_REQUEST_PRIORITY priority)
+{
+  XBMC->Log(LOG_INFO, "%s Open webAPI with URL: '%s'", __FUNCTION__, url);
+
+  m_requestQueue.Acquire(priority);
+  int64_t iStartTime = GetTimeMs();
 
   CCurlFile http;
-  if(!http.Get(url, strTmp))
+  bool bOk = http.Get(url, strResult);
+
+  m_requestQueue.Release(priority, (unsigned int)(GetTimeMs() - iStartTime));
+
+  if(!bOk)
   {
     XBMC->Log(LOG_DEBUG, "%s - Could not open webAPI.", __FUNCTION__);
-    return "";
+    return false;
   }
 
-  XBMC->Log(LOG_INFO, "%s Got result. Length: %u", __FUNCTION__, strTmp.length());
-  
+  XBMC->Log(LOG_INFO, "%s Got result. Length: %u", __FUNCTION__, strResult.length());
 
-  return strTmp;
+  return true;
 }
 
 const char * Vu::GetServerName() 
@@ -604,7 +767,7 @@ int Vu::GetChannelsAmount()
 
 int Vu::GetTimersAmount()
 {
-  return m_timers.size();
+  return m_timers.Size();
 }
 
 unsigned int Vu::GetRecordingsAmount() {
@@ -621,12 +784,16 @@ PVR_ERROR Vu::GetChannels(ADDON_HANDLE handle, bool bRadio)
     iTimer++;
   }
 
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_channels.size(); iChannelPtr++)
+  CLockObject lock(m_mutex);
+
+  // the channels only change with a reload, which drops the prebuilt entries
+  if (m_channelTags.size() != m_channels.size())
   {
-    VuChannel &channel = m_channels.at(iChannelPtr);
-    if (channel.bRadio == bRadio)
+    m_channelTags.resize(m_channels.size());
+    for (unsigned int iChannelPtr = 0; iChannelPtr < m_channels.size(); iChannelPtr++)
     {
-      PVR_CHANNEL xbmcChannel;
+      const VuChannel &channel = m_channels.at(iChannelPtr);
+      PVR_CHANNEL &xbmcChannel = m_channelTags[iChannelPtr];
       memset(&xbmcChannel, 0, sizeof(PVR_CHANNEL));
 
       xbmcChannel.iUniqueId         = channel.iUniqueId;
@@ -637,15 +804,16 @@ PVR_ERROR Vu::GetChannels(ADDON_HANDLE handle, bool bRadio)
       xbmcChannel.iEncryptionSystem = 0;
       xbmcChannel.bIsHidden         = false;
       strncpy(xbmcChannel.strIconPath, channel.strIconPath.c_str(), sizeof(xbmcChannel.strIconPath));
-
-      CStdString strStream;
-      strStream.Format("pvr://stream/tv/%i.ts", channel.iUniqueId);
-      strncpy(xbmcChannel.strStreamURL, strStream.c_str(), sizeof(xbmcChannel.strStreamURL)); 
-
-      PVR->TransferChannelEntry(handle, &xbmcChannel);
+      snprintf(xbmcChannel.strStreamURL, sizeof(xbmcChannel.strStreamURL), "pvr://stream/tv/%i.ts", channel.iUniqueId);
     }
   }
 
+  for (unsigned int iChannelPtr = 0; iChannelPtr < m_channelTags.size(); iChannelPtr++)
+  {
+    if (m_channelTags[iChannelPtr].bIsRadio == bRadio)
+      PVR->TransferChannelEntry(handle, &m_channelTags[iChannelPtr]);
+  }
+
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -657,15 +825,23 @@ Vu::~Vu()
   
   XBMC->Log(LOG_DEBUG, "%s Removing internal channels list...", __FUNCTION__);
   m_channels.clear();  
+  m_channelTags.clear();
+  m_channelIndex.clear();
   
   XBMC->Log(LOG_DEBUG, "%s Removing internal timers list...", __FUNCTION__);
-  m_timers.clear();
+  m_timers.Clear();
   
   XBMC->Log(LOG_DEBUG, "%s Removing internal recordings list...", __FUNCTION__);
-  m_recordings.clear();
+  m_recordingLocations.clear();
   
   XBMC->Log(LOG_DEBUG, "%s Removing internal group list...", __FUNCTION__);
   m_groups.clear();
+  m_groupIndex.clear();
+  m_initialEPG.clear();
+  m_initialEPGStrings.Clear();
+  m_epg.clear();
+  m_coldEPG.Close();
+  m_epgRetry.clear();
   m_bIsConnected = false;
 }
 
@@ -679,88 +855,28 @@ bool Vu::GetInitialEPGForGroup(VuChannelGroup &group)
     iTimer++;
   }
 
-  CStdString url;
-  url.Format("%s%s%s",  m_strURL.c_str(), "web/epgnownext?bRef=",  URLEncodeInline(group.strServiceReference.c_str())); 
- 
-  CStdString strXML;
-  strXML = GetHttpXML(url);
-
-  int iNumEPG = 0;
-  
-  TiXmlDocument xmlDoc;
-  if (!xmlDoc.Parse(strXML.c_str()))
-  {
-    XBMC->Log(LOG_DEBUG, "Unable to parse XML: %s at line %d", xmlDoc.ErrorDesc(), xmlDoc.ErrorRow());
-    return false;
-  }
-
-  TiXmlHandle hDoc(&xmlDoc);
-  TiXmlElement* pElem;
-  TiXmlHandle hRoot(0);
-
-  pElem = hDoc.FirstChildElement("e2eventlist").Element();
+  VuURL url(m_strURL);
+  url.Append(m_bUseJSON ? "api/epgnownext?bRef=" : "web/epgnownext?bRef=").AppendEncoded(group.strServiceReference);
  
-  if (!pElem)
-  {
-    XBMC->Log(LOG_DEBUG, "%s could not find <e2eventlist> element!", __FUNCTION__);
-    // Return "NO_ERROR" as the EPG could be empty for this channel
+  std::vector<VuEPGEntry> entries;
+  if (!LoadEPGEvents(url.c_str(), entries, m_initialEPGStrings, VU_REQUEST_REFRESH))
     return false;
-  }
-
-  hRoot=TiXmlHandle(pElem);
 
-  TiXmlElement* pNode = hRoot.FirstChildElement("e2event").Element();
+  int iNumEPG = 0;
 
-  if (!pNode)
-  {
-    XBMC->Log(LOG_DEBUG, "Could not find <e2event> element");
-    // RETURN "NO_ERROR" as the EPG could be empty for this channel
-    return false;
-  }
-  
-  for (; pNode != NULL; pNode = pNode->NextSiblingElement("e2event"))
+  for (unsigned int i = 0; i < entries.size(); i++)
   {
-    CStdString strTmp;
-
-    int iTmpStart;
-    int iTmp;
-
-    // check and set event starttime and endtimes
-    if (!XMLUtils::GetInt(pNode, "e2eventstart", iTmpStart)) 
-      continue;
-
-    if (!XMLUtils::GetInt(pNode, "e2eventduration", iTmp))
-      continue;
-
-    VuEPGEntry entry;
-    entry.startTime = iTmpStart;
-    entry.endTime = iTmpStart + iTmp;
-
-    if (!XMLUtils::GetInt(pNode, "e2eventid", entry.iEventId))  
-      continue;
-
-    
-    if(!XMLUtils::GetString(pNode, "e2eventtitle", strTmp))
-      continue;
+    VuEPGEntry &entry = entries[i];
 
-    entry.strTitle = strTmp;
+    entry.iChannelId = GetChannelNumberById(entry.iServiceRef);
 
-    if(!XMLUtils::GetString(pNode, "e2eventservicereference", strTmp))
+    // Services shared between bouquets get their initial EPG from the first one only
+    if (entry.iChannelId < 1 || group.strGroupName.compare(m_channels.at(entry.iChannelId-1).strGroupName))
       continue;
 
-    entry.strServiceReference = strTmp;
-    
-    entry.iChannelId = GetChannelNumber(entry.strServiceReference.c_str());
-
-    if (XMLUtils::GetString(pNode, "e2eventdescriptionextended", strTmp))
-      entry.strPlot = strTmp;
-
-    if (XMLUtils::GetString(pNode, "e2eventdescription", strTmp))
-       entry.strPlotOutline = strTmp;
-
     iNumEPG++; 
     
-    group.initialEPG.push_back(entry);
+    m_initialEPG[entry.iServiceRef].push_back(entry);
   }
 
   XBMC->Log(LOG_INFO, "%s Loaded %u EPG Entries for group '%s'", __FUNCTION__, iNumEPG, group.strGroupName.c_str());
@@ -774,57 +890,36 @@ PVR_ERROR Vu::GetInitialEPGForChannel(ADDON_HANDLE handle, const VuChannel &chan
 
   XBMC->Log(LOG_DEBUG, "%s Fetch information for group '%s'", __FUNCTION__, channel.strGroupName.c_str());
 
-  VuChannelGroup &myGroup = m_groups.at(0);
-  for (int i = 0;i<m_iNumChannelGroups;  i++) 
+  VuChannelGroup *myGroup = GetGroup(channel.strGroupName);
+  time_t now = time(NULL);
+  if (myGroup && !myGroup->bInitialEPGLoaded && now >= myGroup->iInitialEPGRetry)
   {
-    myGroup = m_groups.at(i);
-    if (!myGroup.strGroupName.compare(channel.strGroupName))
-      if (myGroup.initialEPG.size() == 0)
-      {
-        GetInitialEPGForGroup(myGroup);
-        break;
-      }
+    // Fetch the now/next events of the whole group only once, a failed
+    // fetch is tried again by the next channel of the group after a while
+    if (GetInitialEPGForGroup(*myGroup))
+      myGroup->bInitialEPGLoaded = true;
+    else
+      myGroup->iInitialEPGRetry = now + EPG_RETRY_DELAY;
   }
 
-  XBMC->Log(LOG_DEBUG, "%s initialEPG size is now '%d'", __FUNCTION__, myGroup.initialEPG.size());
+  std::unordered_map<unsigned int, std::vector<VuEPGEntry> >::const_iterator it = m_initialEPG.find(channel.iServiceRef);
+  if (it == m_initialEPG.end())
+    return PVR_ERROR_NO_ERROR;
+
+  const std::vector<VuEPGEntry> &initialEPG = it->second;
+
+  XBMC->Log(LOG_DEBUG, "%s initialEPG size for channel '%s' is '%d'", __FUNCTION__, channel.strChannelName.c_str(), initialEPG.size());
   
-  for (unsigned int i = 0;i<myGroup.initialEPG.size();  i++) 
+  // only the events in the window Kodi asked for, iEnd <= 1 leaves it open
+  for (unsigned int i = 0;i<initialEPG.size();  i++) 
   {
-    VuEPGEntry &entry = myGroup.initialEPG.at(i);
-    if (!channel.strServiceReference.compare(entry.strServiceReference)) 
-    {
-      EPG_TAG broadcast;
-      memset(&broadcast, 0, sizeof(EPG_TAG));
-
-      broadcast.iUniqueBroadcastId  = entry.iEventId;
-      broadcast.strTitle            = entry.strTitle.c_str();
-      broadcast.iChannelNumber      = channel.iChannelNumber;
-      broadcast.startTime           = entry.startTime;
-      broadcast.endTime             = entry.endTime;
-      broadcast.strPlotOutline      = entry.strPlotOutline.c_str();
-      broadcast.strPlot             = entry.strPlot.c_str();
-      broadcast.strOriginalTitle    = NULL; // unused
-      broadcast.strCast             = NULL; // unused
-      broadcast.strDirector         = NULL; // unused
-      broadcast.strWriter           = NULL; // unused
-      broadcast.iYear               = 0;    // unused
-      broadcast.strIMDBNumber       = NULL; // unused
-      broadcast.strIconPath         = ""; // unused
-      broadcast.iGenreType          = 0; // unused
-      broadcast.iGenreSubType       = 0; // unused
-      broadcast.strGenreDescription = "";
-      broadcast.firstAired          = 0;  // unused
-      broadcast.iParentalRating     = 0;  // unused
-      broadcast.iStarRating         = 0;  // unused
-      broadcast.bNotify             = false;
-      broadcast.iSeriesNumber       = 0;  // unused
-      broadcast.iEpisodeNumber      = 0;  // unused
-      broadcast.iEpisodePartNumber  = 0;  // unused
-      broadcast.strEpisodeName      = ""; // unused
-
-      PVR->TransferEpgEntry(handle, &broadcast);
-    }
+    const VuEPGEntry &entry = initialEPG.at(i);
+    if (entry.endTime <= iStart || (iEnd > 1 && entry.startTime >= iEnd))
+      continue;
+
+    TransferEPGEntry(handle, entry, channel.iChannelNumber);
   }
+
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -838,7 +933,7 @@ PVR_ERROR Vu::GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANNEL &channel,
     iTimer++;
   }
 
-  if (channel.iUniqueId-1 > m_channels.size())
+  if (channel.iUniqueId < 1 || channel.iUniqueId > m_channels.size())
   {
     XBMC->Log(LOG_ERROR, "%s Could not fetch cannel object - not fetching EPG for channel with UniqueID '%d'", __FUNCTION__, channel.iUniqueId);
     return PVR_ERROR_NO_ERROR;
@@ -869,138 +964,422 @@ PVR_ERROR Vu::GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANNEL &channel,
       XBMC->WriteFile(m_writeHandle, "N", 1);
       XBMC->CloseFile(m_writeHandle);
     }
-    return GetInitialEPGForChannel(handle, myChannel, iStart, iEnd);
-  }
-
-  CStdString url;
-  url.Format("%s%s%s",  m_strURL.c_str(), "web/epgservice?sRef=",  URLEncodeInline(myChannel.strServiceReference.c_str())); 
- 
-  CStdString strXML;
-  strXML = GetHttpXML(url);
 
-  int iNumEPG = 0;
+    PVR_ERROR error = GetInitialEPGForChannel(handle, myChannel, iStart, iEnd);
 
-  TiXmlDocument xmlDoc;
-  if (!xmlDoc.Parse(strXML.c_str()))
-  {
-    XBMC->Log(LOG_DEBUG, "Unable to parse XML: %s at line %d", xmlDoc.ErrorDesc(), xmlDoc.ErrorRow());
-    return PVR_ERROR_SERVER_ERROR;
+    // Kodi has the now/next events of the channel, once all channels have them the strings go too
+    m_initialEPG.erase(myChannel.iServiceRef);
+    if (!m_bInitialEPG)
+    {
+      std::unordered_map<unsigned int, std::vector<VuEPGEntry> >().swap(m_initialEPG);
+      m_initialEPGStrings.Clear();
+    }
+    return error;
   }
 
-  TiXmlHandle hDoc(&xmlDoc);
-  TiXmlElement* pElem;
-  TiXmlHandle hRoot(0);
+  unsigned int iChannel = channel.iUniqueId-1;
+  if (iEnd <= 1)
+    iEnd = iStart + EPG_OPEN_WINDOW;
 
-  pElem = hDoc.FirstChildElement("e2eventlist").Element();
- 
-  if (!pElem)
+  // Only ask the backend for the parts of the window we don't have yet
+  std::vector<VuTimeRange> missing;
   {
-    XBMC->Log(LOG_DEBUG, "%s could not find <e2eventlist> element!", __FUNCTION__);
-    // Return "NO_ERROR" as the EPG could be empty for this channel
-    return PVR_ERROR_NO_ERROR;
-  }
+    CLockObject lock(m_epgMutex);
+    VuChannelEPG &epg = m_epg.at(iChannel);
 
-  hRoot=TiXmlHandle(pElem);
+    // Forget an outdated EPG, the requested window is fetched again below.
+    // The same goes for an EPG whose descriptions were dropped to save
+    // memory, Kodi would otherwise replace its own copies with empty ones.
+    time_t now = time(NULL);
+    if ((epg.GetLastUpdate() != 0 && !epg.IsValid(now)) || !epg.HasDescriptions(std::max(iStart, now), iEnd))
+    {
+      epg.Clear();
+      m_coldEPG.Discard(iChannel);
+    }
 
-  TiXmlElement* pNode = hRoot.FirstChildElement("e2event").Element();
+    epg.GetMissingRanges(iStart, iEnd, missing);
+  }
 
-  if (!pNode)
+  // fetched without the lock, so that other channels and timers need not wait for the receiver
+  std::vector<std::vector<VuEPGEntry> > entries(missing.size());
+  std::vector<VuStringArena> strings(missing.size());
+  for (unsigned int i = 0; i < missing.size(); i++)
   {
-    XBMC->Log(LOG_DEBUG, "Could not find <e2event> element");
-    // RETURN "NO_ERROR" as the EPG could be empty for this channel
-    return PVR_ERROR_SERVER_ERROR;
+    if (!LoadEPGForChannel(myChannel, missing[i].first, missing[i].second, entries[i], strings[i]))
+      return PVR_ERROR_SERVER_ERROR;
   }
-  
-  for (; pNode != NULL; pNode = pNode->NextSiblingElement("e2event"))
-  {
-    CStdString strTmp;
 
-    int iTmpStart;
-    int iTmp;
+  CLockObject lock(m_epgMutex);
 
-    // check and set event starttime and endtimes
-    if (!XMLUtils::GetInt(pNode, "e2eventstart", iTmpStart)) 
-      continue;
+  // the channels may have been reloaded meanwhile
+  if (iChannel >= m_epg.size())
+    return PVR_ERROR_NO_ERROR;
 
-    // Skip unneccessary events
-    if (iStart > iTmpStart)
-      continue;
+  VuChannelEPG &epg = m_epg.at(iChannel);
+  for (unsigned int i = 0; i < missing.size(); i++)
+  {
+    epg.Merge(entries[i], strings[i], missing[i].first, missing[i].second);
+    SpillColdEPG(iChannel, missing[i].first, missing[i].second);
+  }
+
+  TouchEPG(iChannel);
+
+  unsigned int iFirst, iLast;
+  epg.GetWindow(iStart, iEnd, iFirst, iLast);
+
+  for (unsigned int i = iFirst; i < iLast; i++)
+    TransferEPGEntry(handle, epg.At(i), channel.iChannelNumber);
+
+  // the days beyond the hot window are read back from the cold segment
+  std::vector<VuEPGEntry> cold;
+  VuStringArena coldStrings;
+  if (m_coldEPG.IsOpen() && !m_coldEPG.Read(iChannel, iStart, iEnd, cold, coldStrings))
+    return PVR_ERROR_FAILED;
+
+  for (unsigned int i = 0; i < cold.size(); i++)
+    TransferEPGEntry(handle, cold[i], channel.iChannelNumber);
+
+  XBMC->Log(LOG_INFO, "%s Transferred %u EPG Entries for channel '%s'", __FUNCTION__, iLast - iFirst + (unsigned int)cold.size(), channel.strChannelName);
+  return PVR_ERROR_NO_ERROR;
+}
+
+void Vu::SpillColdEPG(unsigned int iChannel, time_t iStart, time_t iEnd)
+{
+  if (!m_coldEPG.IsOpen())
+    return;
+
+  // the backend answer for [iStart, iEnd) replaces what went to disk before,
+  // events it repeats unchanged keep their record
+  time_t iHotEnd = time(NULL) + g_iEPGHotWindow * 60 * 60;
+  m_coldEPG.BeginUpdate(iChannel, iStart, iEnd);
+  m_epg.at(iChannel).Evict(iHotEnd, [this, iChannel](const VuEPGEntry &entry) { return m_coldEPG.Store(iChannel, entry); });
+  m_coldEPG.EndUpdate(iChannel);
+}
+
+unsigned int Vu::GetEPGFingerprint(unsigned int iChannel)
+{
+  // the same events give the same sum whichever tier holds them
+  unsigned int iFingerprint = m_epg.at(iChannel).GetFingerprint();
+  if (m_coldEPG.IsOpen())
+    iFingerprint += m_coldEPG.GetFingerprint(iChannel);
+  return iFingerprint;
+}
+
+void Vu::CompactColdEPG()
+{
+  VuEPGColdStore::Compaction compaction;
+  {
+    CLockObject lock(m_epgMutex);
+    if (!m_coldEPG.PrepareCompaction(compaction))
+      return;
+  }
+
+  // the copy may take a while, refreshes carry on meanwhile
+  VuEPGColdStore::CopyRecords(compaction);
+
+  CLockObject lock(m_epgMutex);
+  m_coldEPG.FinishCompaction(compaction);
+}
+
+VU_TASK_RESULT Vu::PromoteEPGTask()
+{
+  time_t iHotEnd = time(NULL) + g_iEPGHotWindow * 60 * 60;
+  unsigned int iPromoted = 0;
+
+  {
+    CLockObject lock(m_epgMutex);
+    for (unsigned int i = 0; i < m_epg.size(); i++)
+    {
+      std::vector<VuEPGEntry> entries;
+      VuStringArena strings;
+      if (!m_coldEPG.Read(i, 0, iHotEnd, entries, strings) || entries.empty())
+        continue;
+
+      // the hot tier holds nothing in this range, it was covered before the events were spilled
+      time_t iStart = entries.front().startTime;
+      time_t iEnd = entries.back().startTime + 1;
+      m_coldEPG.Discard(i, iStart, iEnd);
+      iPromoted += entries.size();
+      m_epg.at(i).Merge(entries, strings, iStart, iEnd);
+
+      // moving the window is no use of the channel, it keeps its place in the LRU order
+      m_descriptionLRU.Resize(i, m_epg.at(i).GetDescriptionSize());
+      m_epgLRU.Resize(i, m_epg.at(i).GetMemorySize());
+    }
+
+    if (iPromoted > 0)
+      XBMC->Log(LOG_DEBUG, "%s Moved %u EPG entries into memory", __FUNCTION__, iPromoted);
+  }
+
+  CompactColdEPG();
+
+  // the receiver is not asked, only the segment is read
+  return VU_TASK_IDLE;
+}
+
+void Vu::KeepDescriptions(unsigned int iChannel)
+{
+  if (g_iEPGDescriptionCache <= 0)
+    return;
+
+  // the channel just loaded is kept even if it exceeds the budget on its own
+  size_t iBudget = (size_t)g_iEPGDescriptionCache * 1024 * 1024;
+  m_descriptionLRU.Touch(iChannel, m_epg.at(iChannel).GetDescriptionSize());
+
+  unsigned int iOldest;
+  while (m_descriptionLRU.GetSize() > iBudget && m_descriptionLRU.GetOldest(iOldest) && iOldest != iChannel)
+  {
+    XBMC->Log(LOG_DEBUG, "%s Dropping EPG descriptions of channel '%s'", __FUNCTION__, m_channels.at(iOldest).strChannelName.c_str());
+    m_epg.at(iOldest).DropDescriptions();
+    m_descriptionLRU.Remove(iOldest);
+    m_epgLRU.Resize(iOldest, m_epg.at(iOldest).GetMemorySize());
+  }
+}
+
+void Vu::TouchEPG(unsigned int iChannel)
+{
+  KeepDescriptions(iChannel);
+
+  if (g_iEPGMemoryBudget <= 0)
+    return;
+
+  // Whole channels are released, Kodi asking for them again fetches them anew.
+  // The channel just loaded is kept even if it exceeds the budget on its own.
+  size_t iBudget = (size_t)g_iEPGMemoryBudget * 1024 * 1024;
+  m_epgLRU.Touch(iChannel, m_epg.at(iChannel).GetMemorySize());
+
+  unsigned int iOldest;
+  while (m_epgLRU.GetSize() > iBudget && m_epgLRU.GetOldest(iOldest) && iOldest != iChannel)
+  {
+    XBMC->Log(LOG_DEBUG, "%s Releasing the EPG of channel '%s'", __FUNCTION__, m_channels.at(iOldest).strChannelName.c_str());
+    m_epg.at(iOldest).Clear();
+    m_coldEPG.Discard(iOldest);
+    m_epgLRU.Remove(iOldest);
+    m_descriptionLRU.Remove(iOldest);
+  }
+}
+
+bool Vu::LoadEPGForChannel(const VuChannel &channel, time_t iStart, time_t iEnd, std::vector<VuEPGEntry> &entries, VuStringArena &arena, VU_REQUEST_PRIORITY priority)
+{
+  // endTime is passed on to the EPG cache lookup, which expects a duration in minutes
+  VuURL url(m_strURL);
+  url.Append(m_bUseJSON ? "api/epgservice?sRef=" : "web/epgservice?sRef=").Append(channel.strEncodedServiceReference);
+  url.Append("&time=").AppendInt(iStart).Append("&endTime=").AppendInt((iEnd - iStart + 59) / 60);
  
-    if (!XMLUtils::GetInt(pNode, "e2eventduration", iTmp))
-      continue;
+  if (!LoadEPGEvents(url.c_str(), entries, arena, priority))
+    return false;
 
-    if ((iEnd > 1) && (iEnd < (iTmpStart + iTmp)))
-       continue;
-    
-    VuEPGEntry entry;
-    entry.startTime = iTmpStart;
-    entry.endTime = iTmpStart + iTmp;
+  for (unsigned int i = 0; i < entries.size(); i++)
+  {
+    entries[i].iChannelId = channel.iUniqueId;
+    entries[i].iServiceRef = channel.iServiceRef;
+  }
 
-    if (!XMLUtils::GetInt(pNode, "e2eventid", entry.iEventId))  
-      continue;
+  XBMC->Log(LOG_INFO, "%s Loaded %u EPG Entries for channel '%s' from '%d' to '%d'", __FUNCTION__, entries.size(), channel.strChannelName.c_str(), (int)iStart, (int)iEnd);
+  return true;
+}
 
-    entry.iChannelId = channel.iUniqueId;
-    
-    if(!XMLUtils::GetString(pNode, "e2eventtitle", strTmp))
+bool Vu::LoadEPGEvents(const char *url, std::vector<VuEPGEntry> &entries, VuStringArena &arena, VU_REQUEST_PRIORITY priority)
+{
+  CStdString strXML;
+  strXML = GetHttpXML(url, priority);
+
+  if (m_bUseJSON)
+    return ParseEventsJSON(strXML, entries, arena);
+
+  TiXmlDocument xmlDoc;
+  if (!xmlDoc.Parse(strXML.c_str()))
+  {
+    XBMC->Log(LOG_DEBUG, "Unable to parse XML: %s at line %d", xmlDoc.ErrorDesc(), xmlDoc.ErrorRow());
+    return false;
+  }
+
+  TiXmlHandle hDoc(&xmlDoc);
+  TiXmlElement* pElem;
+  TiXmlHandle hRoot(0);
+
+  pElem = hDoc.FirstChildElement("e2eventlist").Element();
+ 
+  if (!pElem)
+  {
+    XBMC->Log(LOG_DEBUG, "%s could not find <e2eventlist> element!", __FUNCTION__);
+    // Not an error as the EPG could be empty for this channel
+    return true;
+  }
+
+  hRoot=TiXmlHandle(pElem);
+
+  TiXmlElement* pNode = hRoot.FirstChildElement("e2event").Element();
+
+  if (!pNode)
+  {
+    XBMC->Log(LOG_DEBUG, "Could not find <e2event> element");
+    // Not an error as the EPG could be empty for this channel
+    return true;
+  }
+  
+  for (; pNode != NULL; pNode = pNode->NextSiblingElement("e2event"))
+  {
+    VuEPGRow row;
+    row.entry.iChannelId = -1;
+    row.entry.iServiceRef = SERVICE_REF_NONE;
+    row.strings = &arena;
+    row.serviceRefs = &m_serviceRefs;
+
+    if (!VuXMLRead(pNode, EPGFields, row))
       continue;
 
-    entry.strTitle = strTmp;
-    
-    entry.strServiceReference = myChannel.strServiceReference.c_str();
-
-    if (XMLUtils::GetString(pNode, "e2eventdescriptionextended", strTmp))
-      entry.strPlot = strTmp;
-
-    if (XMLUtils::GetString(pNode, "e2eventdescription", strTmp))
-       entry.strPlotOutline = strTmp;
-
-    EPG_TAG broadcast;
-    memset(&broadcast, 0, sizeof(EPG_TAG));
-
-    broadcast.iUniqueBroadcastId  = entry.iEventId;
-    broadcast.strTitle            = entry.strTitle.c_str();
-    broadcast.iChannelNumber      = channel.iChannelNumber;
-    broadcast.startTime           = entry.startTime;
-    broadcast.endTime             = entry.endTime;
-    broadcast.strPlotOutline      = entry.strPlotOutline.c_str();
-    broadcast.strPlot             = entry.strPlot.c_str();
-    broadcast.strOriginalTitle    = NULL; // unused
-    broadcast.strCast             = NULL; // unused
-    broadcast.strDirector         = NULL; // unused
-    broadcast.strWriter           = NULL; // unused
-    broadcast.iYear               = 0;    // unused
-    broadcast.strIMDBNumber       = NULL; // unused
-    broadcast.strIconPath         = ""; // unused
-    broadcast.iGenreType          = 0; // unused
-    broadcast.iGenreSubType       = 0; // unused
-    broadcast.strGenreDescription = "";
-    broadcast.firstAired          = 0;  // unused
-    broadcast.iParentalRating     = 0;  // unused
-    broadcast.iStarRating         = 0;  // unused
-    broadcast.bNotify             = false;
-    broadcast.iSeriesNumber       = 0;  // unused
-    broadcast.iEpisodeNumber      = 0;  // unused
-    broadcast.iEpisodePartNumber  = 0;  // unused
-    broadcast.strEpisodeName      = ""; // unused
-
-    PVR->TransferEpgEntry(handle, &broadcast);
+    VuEPGEntry &entry = row.entry;
+    entry.endTime = entry.startTime + row.iDuration;
 
-    iNumEPG++; 
+    entries.push_back(entry);
 
-    XBMC->Log(LOG_DEBUG, "%s loaded EPG entry '%d:%s' channel '%d' start '%d' end '%d'", __FUNCTION__, broadcast.iUniqueBroadcastId, broadcast.strTitle, entry.iChannelId, entry.startTime, entry.endTime);
+    XBMC->Log(LOG_DEBUG, "%s loaded EPG entry '%d:%s' start '%d' end '%d'", __FUNCTION__, entry.iEventId, entry.strTitle.c_str(), entry.startTime, entry.endTime);
   }
 
-  XBMC->Log(LOG_INFO, "%s Loaded %u EPG Entries for channel '%s'", __FUNCTION__, iNumEPG, channel.strChannelName);
-  return PVR_ERROR_NO_ERROR;
+  return true;
 }
 
-int Vu::GetChannelNumber(CStdString strServiceReference)  
+VU_TASK_RESULT Vu::RefreshNextEPG()
 {
-  for (unsigned int i = 0;i<m_channels.size();  i++) 
+  time_t now = time(NULL);
+  unsigned int iChannel = m_channels.size();
+
+  // Channels close to the one being watched come first and are refreshed more often
   {
-    if (!strServiceReference.compare(m_channels[i].strServiceReference))
-      return i+1;
+    CLockObject lock(m_epgMutex);
+    unsigned int iCurrent = m_iCurrentChannel > 0 ? m_iCurrentChannel-1 : 0;
+    unsigned int iBestDistance = m_epg.size();
+
+    for (unsigned int i = 0; i < m_epg.size(); i++)
+    {
+      unsigned int iDistance = i > iCurrent ? i - iCurrent : iCurrent - i;
+      iDistance = std::min(iDistance, (unsigned int)m_epg.size() - iDistance);
+
+      time_t iInterval = EPG_REFRESH_INTERVAL;
+      if (iDistance > EPG_NEAR_CHANNELS)
+        iInterval *= EPG_FAR_REFRESH_FACTOR;
+
+      // with a memory budget, channels Kodi has not asked for or that were released stay out
+      if (g_iEPGMemoryBudget > 0 && m_epg.at(i).GetLastUpdate() == 0)
+        continue;
+
+      // a channel whose refresh failed waits, so that it does not starve the others
+      if (now < m_epgRetry.at(i))
+        continue;
+
+      if (iDistance < iBestDistance && now - m_epg.at(i).GetLastUpdate() >= iInterval)
+      {
+        iChannel = i;
+        iBestDistance = iDistance;
+      }
+    }
+  }
+
+  if (iChannel >= m_channels.size())
+    return VU_TASK_IDLE;
+
+  // The near future is fetched again as it changes most, later days only where
+  // the open window moved past what we have. Now and then the whole window.
+  std::vector<VuTimeRange> ranges;
+  bool bFull;
+  {
+    CLockObject lock(m_epgMutex);
+    const VuChannelEPG &epg = m_epg.at(iChannel);
+    bFull = now - epg.GetLastFullUpdate() >= EPG_FULL_REFRESH_INTERVAL;
+    if (bFull)
+      ranges.push_back(VuTimeRange(now, now + EPG_OPEN_WINDOW));
+    else
+    {
+      epg.GetMissingRanges(now + EPG_NEAR_WINDOW, now + EPG_OPEN_WINDOW, ranges);
+      ranges.insert(ranges.begin(), VuTimeRange(now, now + EPG_NEAR_WINDOW));
+    }
+  }
+
+  VuChannel myChannel = m_channels.at(iChannel);
+  std::vector<std::vector<VuEPGEntry> > entries(ranges.size());
+  std::vector<VuStringArena> strings(ranges.size());
+  for (unsigned int i = 0; i < ranges.size(); i++)
+  {
+    if (!LoadEPGForChannel(myChannel, ranges[i].first, ranges[i].second, entries[i], strings[i], VU_REQUEST_BACKGROUND))
+    {
+      CLockObject lock(m_epgMutex);
+      m_epgRetry.at(iChannel) = now + EPG_RETRY_DELAY;
+      return VU_TASK_FAILED;
+    }
+  }
+
+  unsigned int iOldFingerprint, iNewFingerprint;
+  {
+    CLockObject lock(m_epgMutex);
+    VuChannelEPG &epg = m_epg.at(iChannel);
+    iOldFingerprint = GetEPGFingerprint(iChannel);
+    for (unsigned int i = 0; i < ranges.size(); i++)
+    {
+      epg.Merge(entries[i], strings[i], ranges[i].first, ranges[i].second);
+      SpillColdEPG(iChannel, ranges[i].first, ranges[i].second);
+    }
+    epg.SetLastUpdate(now);
+    if (bFull)
+      epg.SetLastFullUpdate(now);
+    iNewFingerprint = GetEPGFingerprint(iChannel);
+    TouchEPG(iChannel);
   }
+
+  // Only make Kodi fetch the EPG again if something has changed
+  if (iOldFingerprint != iNewFingerprint)
+  {
+    XBMC->Log(LOG_DEBUG, "%s - Trigger EPG update for channel '%s'", __FUNCTION__, myChannel.strChannelName.c_str());
+    PVR->TriggerEpgUpdate(myChannel.iUniqueId);
+  }
+
+  return VU_TASK_DONE;
+}
+
+void Vu::TransferEPGEntry(ADDON_HANDLE handle, const VuEPGEntry &entry, int iChannelNumber)
+{
+  EPG_TAG broadcast;
+  memset(&broadcast, 0, sizeof(EPG_TAG));
+
+  broadcast.iUniqueBroadcastId  = entry.iEventId;
+  broadcast.strTitle            = entry.strTitle.c_str();
+  broadcast.iChannelNumber      = iChannelNumber;
+  broadcast.startTime           = entry.startTime;
+  broadcast.endTime             = entry.endTime;
+  broadcast.strPlotOutline      = entry.strPlotOutline.c_str();
+  broadcast.strPlot             = entry.strPlot.c_str();
+  broadcast.strOriginalTitle    = NULL; // unused
+  broadcast.strCast             = NULL; // unused
+  broadcast.strDirector         = NULL; // unused
+  broadcast.strWriter           = NULL; // unused
+  broadcast.iYear               = 0;    // unused
+  broadcast.strIMDBNumber       = NULL; // unused
+  broadcast.strIconPath         = ""; // unused
+  broadcast.iGenreType          = 0; // unused
+  broadcast.iGenreSubType       = 0; // unused
+  broadcast.strGenreDescription = "";
+  broadcast.firstAired          = 0;  // unused
+  broadcast.iParentalRating     = 0;  // unused
+  broadcast.iStarRating         = 0;  // unused
+  broadcast.bNotify             = false;
+  broadcast.iSeriesNumber       = 0;  // unused
+  broadcast.iEpisodeNumber      = 0;  // unused
+  broadcast.iEpisodePartNumber  = 0;  // unused
+  broadcast.strEpisodeName      = ""; // unused
+
+  PVR->TransferEpgEntry(handle, &broadcast);
+}
+
+int Vu::GetChannelNumber(CStdString strServiceReference)  
+{
+  return GetChannelNumberById(m_serviceRefs.Find(strServiceReference));
+}
+
+int Vu::GetChannelNumberById(unsigned int iServiceRef)
+{
+  if (iServiceRef < m_channelIndex.size() && m_channelIndex[iServiceRef] != 0)
+    return m_channelIndex[iServiceRef];
+
   return -1;
 }
 
@@ -1024,53 +1403,36 @@ PVR_ERROR Vu::GetTimers(ADDON_HANDLE handle)
     iTimer++;
   }
 
-  XBMC->Log(LOG_INFO, "%s - timers available '%d'", __FUNCTION__, m_timers.size());
-  for (unsigned int i=0; i<m_timers.size(); i++)
-  {
-    VuTimer &timer = m_timers.at(i);
-    XBMC->Log(LOG_DEBUG, "%s - Transfer timer '%s', ClientIndex '%d'", __FUNCTION__, timer.strTitle.c_str(), timer.iClientIndex);
-    PVR_TIMER tag;
-    memset(&tag, 0, sizeof(PVR_TIMER));
-    tag.iClientChannelUid = timer.iChannelId;
-    tag.startTime         = timer.startTime;
-    tag.endTime           = timer.endTime;
-    strncpy(tag.strTitle, timer.strTitle.c_str(), sizeof(tag.strTitle));
-    strncpy(tag.strDirectory, "/", sizeof(tag.strDirectory));   // unused
-    strncpy(tag.strSummary, timer.strPlot.c_str(), sizeof(tag.strSummary));
-    tag.state             = timer.state;
-    tag.iPriority         = 0;     // unused
-    tag.iLifetime         = 0;     // unused
-    tag.bIsRepeating      = timer.bRepeating;
-    tag.firstDay          = 0;     // unused
-    tag.iWeekdays         = timer.iWeekdays;
-    tag.iEpgUid           = timer.iEpgID;
-    tag.iMarginStart      = 0;     // unused
-    tag.iMarginEnd        = 0;     // unused
-    tag.iGenreType        = 0;     // unused
-    tag.iGenreSubType     = 0;     // unused
-    tag.iClientIndex = timer.iClientIndex;
+  CLockObject lock(m_mutex);
 
+  XBMC->Log(LOG_INFO, "%s - timers available '%d'", __FUNCTION__, m_timers.Size());
+  m_timers.ForEachTag([handle](const PVR_TIMER &tag)
+  {
+    XBMC->Log(LOG_DEBUG, "%s - Transfer timer '%s', ClientIndex '%d'", __FUNCTION__, tag.strTitle, tag.iClientIndex);
     PVR->TransferTimerEntry(handle, &tag);
-  }
+  });
 
   return PVR_ERROR_NO_ERROR;
 }
 
-std::vector<VuTimer> Vu::LoadTimers()
+bool Vu::LoadTimers(std::vector<VuTimer> &timers, VU_REQUEST_PRIORITY priority)
 {
-  std::vector<VuTimer> timers;
-
   CStdString url; 
-  url.Format("%s%s", m_strURL.c_str(), "web/timerlist"); 
+  url.Format("%s%s", m_strURL.c_str(), m_bUseJSON ? "api/timerlist" : "web/timerlist"); 
 
   CStdString strXML;
-  strXML = GetHttpXML(url);
+  strXML = GetHttpXML(url.c_str(), priority);
+  if (strXML.empty())
+    return false;
+
+  if (m_bUseJSON)
+    return ParseTimersJSON(strXML, timers);
 
   TiXmlDocument xmlDoc;
   if (!xmlDoc.Parse(strXML.c_str()))
   {
     XBMC->Log(LOG_DEBUG, "Unable to parse XML: %s at line %d", xmlDoc.ErrorDesc(), xmlDoc.ErrorRow());
-    return timers;
+    return false;
   }
 
   TiXmlHandle hDoc(&xmlDoc);
@@ -1082,130 +1444,105 @@ std::vector<VuTimer> Vu::LoadTimers()
   if (!pElem)
   {
     XBMC->Log(LOG_DEBUG, "%s Could not find <e2timerlist> element!", __FUNCTION__);
-    return timers;
+    return false;
   }
 
   hRoot=TiXmlHandle(pElem);
 
   TiXmlElement* pNode = hRoot.FirstChildElement("e2timer").Element();
 
+  // no <e2timer> element is a valid answer, the receiver has no timers
   if (!pNode)
   {
     XBMC->Log(LOG_DEBUG, "Could not find <e2timer> element");
-    return timers;
+    return true;
   }
   
   for (; pNode != NULL; pNode = pNode->NextSiblingElement("e2timer"))
   {
-    CStdString strTmp;
+    VuTimerRow row;
+    row.timer.iChannelId = -1;
+    row.timer.iServiceRef = SERVICE_REF_NONE;
+    row.serviceRefs = &m_serviceRefs;
+    row.timer.iWeekdays = 0;
+    row.timer.iEpgID = 0;
+    row.bCancelled = false;
 
-    int iTmp;
-    bool bTmp;
-    int iDisabled;
-    
-    if (XMLUtils::GetString(pNode, "e2name", strTmp)) 
-      XBMC->Log(LOG_DEBUG, "%s Processing timer '%s'", __FUNCTION__, strTmp.c_str());
- 
-    if (!XMLUtils::GetInt(pNode, "e2state", iTmp)) 
+    if (!VuXMLRead(pNode, TimerFields, row))
       continue;
 
-    if (!XMLUtils::GetInt(pNode, "e2disabled", iDisabled))
-      continue;
+    VuTimer &timer = row.timer;
+    XBMC->Log(LOG_DEBUG, "%s Processing timer '%s'", __FUNCTION__, timer.strTitle.c_str());
 
-    VuTimer timer;
-    
-    timer.strTitle          = strTmp;
+    if (timer.iServiceRef != SERVICE_REF_NONE)
+      timer.iChannelId = GetChannelNumberById(timer.iServiceRef);
 
-    if (XMLUtils::GetString(pNode, "e2servicereference", strTmp))
-      timer.iChannelId = GetChannelNumber(strTmp.c_str());
+    timer.bRepeating = (timer.iWeekdays != 0);
+    timer.state = GetTimerState(row.iState, row.iDisabled, row.bCancelled);
 
-    if (!XMLUtils::GetInt(pNode, "e2timebegin", iTmp)) 
-      continue; 
- 
-    timer.startTime         = iTmp;
-    
-    if (!XMLUtils::GetInt(pNode, "e2timeend", iTmp)) 
-      continue; 
- 
-    timer.endTime           = iTmp;
-    
-    if (XMLUtils::GetString(pNode, "e2description", strTmp))
-      timer.strPlot        = strTmp.c_str();
- 
-    if (XMLUtils::GetInt(pNode, "e2repeated", iTmp))
-      timer.iWeekdays         = iTmp;
-    else 
-      timer.iWeekdays = 0;
+    timers.push_back(timer);
 
-    if (timer.iWeekdays != 0)
-      timer.bRepeating      = true; 
-    else
-      timer.bRepeating = false;
-    
-    if (XMLUtils::GetInt(pNode, "e2eit", iTmp))
-      timer.iEpgID = iTmp;
-    else 
-      timer.iEpgID = 0;
+    XBMC->Log(LOG_INFO, "%s fetched Timer entry '%s', begin '%d', end '%d'", __FUNCTION__, timer.strTitle.c_str(), timer.startTime, timer.endTime);
+  }
 
-    timer.state = PVR_TIMER_STATE_NEW;
+  XBMC->Log(LOG_INFO, "%s fetched %u Timer Entries", __FUNCTION__, timers.size());
+  return true;
+}
 
-    if (!XMLUtils::GetInt(pNode, "e2state", iTmp))
-      continue;
+PVR_TIMER_STATE Vu::GetTimerState(int iState, int iDisabled, bool bCancelled)
+{
+  PVR_TIMER_STATE state = PVR_TIMER_STATE_NEW;
 
-    XBMC->Log(LOG_DEBUG, "%s e2state is: %d ", __FUNCTION__, iTmp);
+  XBMC->Log(LOG_DEBUG, "%s e2state is: %d ", __FUNCTION__, iState);
   
-    if (iTmp == 0) 
-    {
-      timer.state = PVR_TIMER_STATE_SCHEDULED;
-      XBMC->Log(LOG_DEBUG, "%s Timer state is: SCHEDULED", __FUNCTION__);
-    }
-    
-    if (iTmp == 2) 
-    {
-      timer.state = PVR_TIMER_STATE_RECORDING;
-      XBMC->Log(LOG_DEBUG, "%s Timer state is: RECORDING", __FUNCTION__);
-    }
-    
-    if (iTmp == 3 && iDisabled == 0) 
-    {
-      timer.state = PVR_TIMER_STATE_COMPLETED;
-      XBMC->Log(LOG_DEBUG, "%s Timer state is: COMPLETED", __FUNCTION__);
-    }
-
-    if (XMLUtils::GetBoolean(pNode, "e2cancled", bTmp)) 
-    {
-      if (bTmp)  
-      {
-        timer.state = PVR_TIMER_STATE_ABORTED;
-        XBMC->Log(LOG_DEBUG, "%s Timer state is: ABORTED", __FUNCTION__);
-      }
-    }
-
-    if (iDisabled == 1) 
-    {
-      timer.state = PVR_TIMER_STATE_CANCELLED;
-      XBMC->Log(LOG_DEBUG, "%s Timer state is: Cancelled", __FUNCTION__);
-    }
-
-    if (timer.state == PVR_TIMER_STATE_NEW)
-      XBMC->Log(LOG_DEBUG, "%s Timer state is: NEW", __FUNCTION__);
+  if (iState == 0) 
+  {
+    state = PVR_TIMER_STATE_SCHEDULED;
+    XBMC->Log(LOG_DEBUG, "%s Timer state is: SCHEDULED", __FUNCTION__);
+  }
+  
+  if (iState == 2) 
+  {
+    state = PVR_TIMER_STATE_RECORDING;
+    XBMC->Log(LOG_DEBUG, "%s Timer state is: RECORDING", __FUNCTION__);
+  }
+  
+  if (iState == 3 && iDisabled == 0) 
+  {
+    state = PVR_TIMER_STATE_COMPLETED;
+    XBMC->Log(LOG_DEBUG, "%s Timer state is: COMPLETED", __FUNCTION__);
+  }
 
-    timers.push_back(timer);
+  if (bCancelled)  
+  {
+    state = PVR_TIMER_STATE_ABORTED;
+    XBMC->Log(LOG_DEBUG, "%s Timer state is: ABORTED", __FUNCTION__);
+  }
 
-    XBMC->Log(LOG_INFO, "%s fetched Timer entry '%s', begin '%d', end '%d'", __FUNCTION__, timer.strTitle.c_str(), timer.startTime, timer.endTime);
+  if (iDisabled == 1) 
+  {
+    state = PVR_TIMER_STATE_CANCELLED;
+    XBMC->Log(LOG_DEBUG, "%s Timer state is: Cancelled", __FUNCTION__);
   }
 
-  XBMC->Log(LOG_INFO, "%s fetched %u Timer Entries", __FUNCTION__, timers.size());
-  return timers; 
+  if (state == PVR_TIMER_STATE_NEW)
+    XBMC->Log(LOG_DEBUG, "%s Timer state is: NEW", __FUNCTION__);
+
+  return state;
 }
 
-bool Vu::SendSimpleCommand(const CStdString& strCommandURL, CStdString& strResultText, bool bIgnoreResult)
+bool Vu::SendSimpleCommand(const char *strCommandURL, CStdString& strResultText, bool bIgnoreResult, VU_REQUEST_PRIORITY priority)
 {
-  CStdString url; 
-  url.Format("%s%s", m_strURL.c_str(), strCommandURL.c_str()); 
+  VuURL url(m_strURL);
+  url.Append(strCommandURL);
 
-  CStdString strXML;
-  strXML = GetHttpXML(url);
+  // commands are never shared, and they make the cached responses outdated
+  std::string strXML;
+  bool bOk = FetchURL(url.c_str(), strXML, priority);
+  m_responseCache.Invalidate();
+
+  if (!bOk)
+    strXML.clear();
   
   if (!bIgnoreResult)
   {
@@ -1256,38 +1593,99 @@ PVR_ERROR Vu::AddTimer(const PVR_TIMER &timer)
 {
   XBMC->Log(LOG_DEBUG, "%s - channelUid=%d title=%s epgid=%d", __FUNCTION__, timer.iClientChannelUid, timer.strTitle, timer.iEpgUid);
 
+  CLockObject lock(m_mutex);
+
+  // Kodi may pass a channel that is not in the loaded bouquets
+  if (timer.iClientChannelUid < 1 || (unsigned int)timer.iClientChannelUid > m_channels.size())
+  {
+    XBMC->Log(LOG_ERROR, "%s Unknown channel '%d'", __FUNCTION__, timer.iClientChannelUid);
+    return PVR_ERROR_INVALID_PARAMETERS;
+  }
+
   CStdString strTmp;
-  CStdString strServiceReference = m_channels.at(timer.iClientChannelUid-1).strServiceReference.c_str();
+  const VuChannel &channel = m_channels.at(timer.iClientChannelUid-1);
+  const std::string &strEncodedServiceReference = channel.strEncodedServiceReference;
+
+  if (timer.iEpgUid > 0 && m_timers.FindByEvent(channel.iServiceRef, timer.iEpgUid) != 0)
+  {
+    XBMC->Log(LOG_INFO, "%s Event '%d' is already scheduled", __FUNCTION__, timer.iEpgUid);
+    return PVR_ERROR_ALREADY_PRESENT;
+  }
+  CStdString strSummary = timer.strSummary;
+
+  // Timers created from the EPG get the event description if Kodi did not pass one
+  if (strSummary.empty() && timer.iEpgUid > 0)
+  {
+    CLockObject lock(m_epgMutex);
+    const VuEPGEntry *entry = m_epg.at(timer.iClientChannelUid-1).GetEvent(timer.iEpgUid);
+    VuEPGEntry coldEntry;
+    VuStringArena coldStrings;
+    if (!entry && m_coldEPG.ReadEvent(timer.iClientChannelUid-1, timer.iEpgUid, coldEntry, coldStrings))
+      entry = &coldEntry;
+    if (entry)
+      strSummary = entry->strPlotOutline.c_str();
+  }
 
   if (!g_strRecordingPath.compare(""))
-    strTmp.Format("web/timeradd?sRef=%s&repeated=%d&begin=%d&end=%d&name=%s&description=%s&eit=%d&dirname=&s", URLEncodeInline(strServiceReference), timer.iWeekdays, timer.startTime, timer.endTime, URLEncodeInline(timer.strTitle), URLEncodeInline(timer.strSummary),timer.iEpgUid, URLEncodeInline(g_strRecordingPath));
+    strTmp.Format("web/timeradd?sRef=%s&repeated=%d&begin=%d&end=%d&name=%s&description=%s&eit=%d&dirname=&s", strEncodedServiceReference.c_str(), timer.iWeekdays, timer.startTime, timer.endTime, URLEncodeInline(timer.strTitle), URLEncodeInline(strSummary),timer.iEpgUid, URLEncodeInline(g_strRecordingPath));
   else
-    strTmp.Format("web/timeradd?sRef=%s&repeated=%d&begin=%d&end=%d&name=%s&description=%s&eit=%d", URLEncodeInline(strServiceReference), timer.iWeekdays, timer.startTime, timer.endTime, URLEncodeInline(timer.strTitle), URLEncodeInline(timer.strSummary),timer.iEpgUid);
+    strTmp.Format("web/timeradd?sRef=%s&repeated=%d&begin=%d&end=%d&name=%s&description=%s&eit=%d", strEncodedServiceReference.c_str(), timer.iWeekdays, timer.startTime, timer.endTime, URLEncodeInline(timer.strTitle), URLEncodeInline(strSummary),timer.iEpgUid);
 
   CStdString strResult;
-  if(!SendSimpleCommand(strTmp, strResult)) 
+  if(!SendSimpleCommand(strTmp.c_str(), strResult)) 
     return PVR_ERROR_SERVER_ERROR;
-  
-  TimerUpdates();
+
+  VuTimer newTimer;
+  newTimer.strTitle = timer.strTitle;
+  newTimer.strPlot = strSummary;
+  newTimer.iChannelId = timer.iClientChannelUid;
+  newTimer.iServiceRef = channel.iServiceRef;
+  newTimer.startTime = timer.startTime;
+  newTimer.endTime = timer.endTime;
+  newTimer.iWeekdays = timer.iWeekdays;
+  newTimer.bRepeating = (timer.iWeekdays != 0);
+  newTimer.iEpgID = timer.iEpgUid;
+  newTimer.state = (timer.startTime <= time(NULL)) ? PVR_TIMER_STATE_RECORDING : PVR_TIMER_STATE_SCHEDULED;
+  newTimer.iUpdateState = VU_UPDATE_STATE_FOUND;
+  m_timers.Add(newTimer);
+
+  TimerEdited(false);
 
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR Vu::DeleteTimer(const PVR_TIMER &timer) 
 {
-  CStdString strTmp;
-  CStdString strServiceReference = m_channels.at(timer.iClientChannelUid-1).strServiceReference.c_str();
+  // the timer is identified by its own service, its channel may not be loaded
+  std::string strEncodedServiceReference;
+  {
+    CLockObject lock(m_mutex);
+    const VuTimer *existing = m_timers.Get(timer.iClientIndex);
+    if (!existing)
+    {
+      XBMC->Log(LOG_ERROR, "%s Unknown timer, ClientIndex '%d'", __FUNCTION__, timer.iClientIndex);
+      return PVR_ERROR_INVALID_PARAMETERS;
+    }
+
+    if (!GetEncodedServiceReference(existing->iServiceRef, strEncodedServiceReference))
+    {
+      XBMC->Log(LOG_ERROR, "%s No service reference for timer '%s'", __FUNCTION__, existing->strTitle.c_str());
+      return PVR_ERROR_FAILED;
+    }
+  }
 
-  strTmp.Format("web/timerdelete?sRef=%s&begin=%d&end=%d", URLEncodeInline(strServiceReference.c_str()), timer.startTime, timer.endTime);
+  CStdString strTmp;
+  strTmp.Format("web/timerdelete?sRef=%s&begin=%d&end=%d", strEncodedServiceReference.c_str(), timer.startTime, timer.endTime);
 
   CStdString strResult;
-  if(!SendSimpleCommand(strTmp, strResult)) 
+  if(!SendSimpleCommand(strTmp.c_str(), strResult)) 
     return PVR_ERROR_SERVER_ERROR;
 
-  if (timer.state == PVR_TIMER_STATE_RECORDING)
-    PVR->TriggerRecordingUpdate();
-  
-  TimerUpdates();
+  CLockObject lock(m_mutex);
+  m_timers.Remove(timer.iClientIndex);
+
+  // a stopped recording keeps the part recorded so far
+  TimerEdited(timer.state == PVR_TIMER_STATE_RECORDING);
 
   return PVR_ERROR_NO_ERROR;
 }
@@ -1302,84 +1700,150 @@ PVR_ERROR Vu::GetRecordings(ADDON_HANDLE handle)
     iTimer++;
   }
 
-  m_iNumRecordings = 0;
-  m_recordings.clear();
+  // local edits and the recordings task keep the locations current,
+  // Kodi is served from memory once every location was loaded
+  bool bLoaded;
+  {
+    CLockObject lock(m_mutex);
+    bLoaded = m_bRecordingsLoaded;
+  }
 
-  for (unsigned int i=0; i<m_locations.size(); i++)
+  if (!bLoaded)
   {
-    if (!GetRecordingFromLocation(m_locations[i]))
-    {
-      XBMC->Log(LOG_ERROR, "%s Error fetching lists for folder: '%s'", __FUNCTION__, m_locations[i].c_str());
-    }
+    bool bChanged;
+    RefreshRecordings(VU_REQUEST_REFRESH, bChanged);
   }
 
+  CLockObject lock(m_mutex);
   TransferRecordings(handle);
 
   return PVR_ERROR_NO_ERROR;
 }
 
-bool Vu::IsInRecordingFolder(CStdString strRecordingFolder)
+void Vu::TransferRecordings(ADDON_HANDLE handle)
 {
-  int iMatches = 0;
-  for (unsigned int i = 0; i < m_recordings.size(); i++)
+  // titles recorded more than once get a folder of their own
+  std::unordered_map<VuStringRef, unsigned int, VuStringRefHash, VuStringRefEqual> titleCount;
+  titleCount.reserve(m_iNumRecordings);
+  for (unsigned int j=0; j<m_recordingLocations.size(); j++)
+  {
+    const std::vector<VuRecording> &recordings = m_recordingLocations[j]->GetRecordings();
+    for (unsigned int i=0; i<recordings.size(); i++)
+      titleCount[recordings[i].strTitle]++;
+  }
+
+  for (unsigned int j=0; j<m_recordingLocations.size(); j++)
   {
-    if (strRecordingFolder.compare(m_recordings.at(i).strTitle) == 0)
+    const std::vector<VuRecording> &recordings = m_recordingLocations[j]->GetRecordings();
+    for (unsigned int i=0; i<recordings.size(); i++)
     {
-      iMatches++;
-      XBMC->Log(LOG_DEBUG, "%s Found Recording title '%s' in recordings vector!", __FUNCTION__, strRecordingFolder.c_str());
-      if (iMatches > 1)
-      {
-        XBMC->Log(LOG_DEBUG, "%s Found Recording title twice '%s' in recordings vector!", __FUNCTION__, strRecordingFolder.c_str());
-        return true;    
-      }
+      const VuRecording &recording = recordings[i];
+      PVR_RECORDING tag;
+      memset(&tag, 0, sizeof(PVR_RECORDING));
+      strncpy(tag.strRecordingId, recording.strRecordingId.c_str(), sizeof(tag.strRecordingId));
+      strncpy(tag.strTitle, recording.strTitle.c_str(), sizeof(tag.strTitle));
+      strncpy(tag.strStreamURL, recording.strStreamURL.c_str(), sizeof(tag.strStreamURL));
+      strncpy(tag.strPlotOutline, recording.strPlotOutline.c_str(), sizeof(tag.strPlotOutline));
+      strncpy(tag.strPlot, recording.strPlot.c_str(), sizeof(tag.strPlot));
+      strncpy(tag.strChannelName, recording.strChannelName.c_str(), sizeof(tag.strChannelName));
+      strncpy(tag.strIconPath, recording.strIconPath.c_str(), sizeof(tag.strIconPath));
+
+      if (titleCount[recording.strTitle] > 1)
+        snprintf(tag.strDirectory, sizeof(tag.strDirectory), "/%s/", recording.strTitle.c_str());
+      else
+        strncpy(tag.strDirectory, "/", sizeof(tag.strDirectory));
+
+      tag.recordingTime     = recording.startTime;
+      tag.iDuration         = recording.iDuration;
+
+      PVR->TransferRecordingEntry(handle, &tag);
     }
   }
-
-  return false;
 }
 
-void Vu::TransferRecordings(ADDON_HANDLE handle)
+bool Vu::RefreshRecordings(VU_REQUEST_PRIORITY priority, bool &bAnyChanged)
 {
-  for (unsigned int i=0; i<m_recordings.size(); i++)
-  {
-    CStdString strTmp;
-    VuRecording &recording = m_recordings.at(i);
-    PVR_RECORDING tag;
-    memset(&tag, 0, sizeof(PVR_RECORDING));
-    strncpy(tag.strRecordingId, recording.strRecordingId.c_str(), sizeof(tag.strRecordingId));
-    strncpy(tag.strTitle, recording.strTitle.c_str(), sizeof(tag.strTitle));
-    strncpy(tag.strStreamURL, recording.strStreamURL.c_str(), sizeof(tag.strStreamURL));
-    strncpy(tag.strPlotOutline, recording.strPlotOutline.c_str(), sizeof(tag.strPlotOutline));
-    strncpy(tag.strPlot, recording.strPlot.c_str(), sizeof(tag.strPlot));
-    strncpy(tag.strChannelName, recording.strChannelName.c_str(), sizeof(tag.strChannelName));
-    strncpy(tag.strIconPath, recording.strIconPath.c_str(), sizeof(tag.strIconPath));
-
-    if(IsInRecordingFolder(recording.strTitle))
-      strTmp.Format("/%s/", recording.strTitle.c_str());
-    else
-      strTmp.Format("/");
+  bool bAllLoaded = true;
+  bAnyChanged = false;
 
-    recording.strDirectory = strTmp;
-    strncpy(tag.strDirectory, recording.strDirectory.c_str(), sizeof(tag.strDirectory));
-    tag.recordingTime     = recording.startTime;
-    tag.iDuration         = recording.iDuration;
+  // the set of locations is fixed after Open, only their recordings are replaced
+  for (unsigned int i=0; i<m_recordingLocations.size(); i++)
+  {
+    VuRecordingLocation &location = *m_recordingLocations[i];
+    bool bChanged = false;
+    if (!LoadRecordingLocation(location, bChanged, priority))
+    {
+      XBMC->Log(LOG_ERROR, "%s Error fetching lists for folder: '%s'", __FUNCTION__, location.GetDirectory().c_str());
+      bAllLoaded = false;
+    }
 
-    PVR->TransferRecordingEntry(handle, &tag);
+    bAnyChanged = bAnyChanged || bChanged;
   }
+
+  CLockObject lock(m_mutex);
+  m_iNumRecordings = 0;
+  for (unsigned int i=0; i<m_recordingLocations.size(); i++)
+    m_iNumRecordings += m_recordingLocations[i]->GetRecordings().size();
+
+  // after a failure GetRecordings asks the receiver again instead of serving what we have
+  m_bRecordingsLoaded = bAllLoaded;
+  return bAllLoaded;
 }
 
-bool Vu::GetRecordingFromLocation(CStdString strRecordingFolder)
+bool Vu::LoadRecordingLocation(VuRecordingLocation &location, bool &bChanged, VU_REQUEST_PRIORITY priority)
 {
   CStdString url;
+  bChanged = false;
+
+  const char *strMovieList = m_bUseJSON ? "api/movielist" : "web/movielist";
 
-  if (!strRecordingFolder.compare("default"))
-    url.Format("%s%s", m_strURL.c_str(), "web/movielist"); 
+  if (!location.GetDirectory().compare("default"))
+    url.Format("%s%s", m_strURL.c_str(), strMovieList); 
   else 
-    url.Format("%s%s?dirname=%s", m_strURL.c_str(), "web/movielist", URLEncodeInline(strRecordingFolder.c_str())); 
+    url.Format("%s%s?dirname=%s", m_strURL.c_str(), strMovieList, URLEncodeInline(location.GetDirectory().c_str())); 
  
   CStdString strXML;
-  strXML = GetHttpXML(url);
+  strXML = GetHttpXML(url.c_str(), priority);
+  if (strXML.empty())
+    return false;
+
+  // an unchanged movielist keeps the recordings parsed last time
+  unsigned int iFingerprint = VuStringRefHash()(VuStringRef(strXML.c_str(), strXML.length()));
+  {
+    CLockObject lock(m_mutex);
+    if (location.IsLoaded() && location.GetFingerprint() == iFingerprint)
+    {
+      XBMC->Log(LOG_DEBUG, "%s Recordings in folder '%s' unchanged", __FUNCTION__, location.GetDirectory().c_str());
+      return true;
+    }
+  }
+
+  // parsed without the lock, only the result is swapped in
+
+  VuRecordingLocation loaded(location.GetDirectory());
+  if (m_bUseJSON)
+  {
+    if (ParseRecordingsJSON(strXML, loaded) < 0)
+      return false;
+  }
+  else if (!ParseRecordingsXML(strXML, loaded))
+    return false;
 
+  unsigned int iLoaded = loaded.GetRecordings().size();
+  loaded.SetFingerprint(iFingerprint);
+  {
+    CLockObject lock(m_mutex);
+    location.Replace(loaded);
+  }
+  bChanged = true;
+
+  XBMC->Log(LOG_INFO, "%s Loaded %u Recording Entries from folder '%s'", __FUNCTION__, iLoaded, location.GetDirectory().c_str());
+
+  return true;
+}
+
+bool Vu::ParseRecordingsXML(const std::string &strXML, VuRecordingLocation &location)
+{
   TiXmlDocument xmlDoc;
   if (!xmlDoc.Parse(strXML.c_str()))
   {
@@ -1401,84 +1865,274 @@ bool Vu::GetRecordingFromLocation(CStdString strRecordingFolder)
 
   hRoot=TiXmlHandle(pElem);
 
+  // an empty location is a valid result, the last recording in it may just have been deleted
   TiXmlElement* pNode = hRoot.FirstChildElement("e2movie").Element();
-
-  if (!pNode)
-  {
-    XBMC->Log(LOG_DEBUG, "Could not find <e2movie> element");
-    return false;
-  }
-  
-  int iNumRecording = 0; 
   
   for (; pNode != NULL; pNode = pNode->NextSiblingElement("e2movie"))
   {
-    CStdString strTmp;
-    int iTmp;
+    VuRecordingRow row;
+    row.recording.iLastPlayedPosition = 0;
+    row.recording.startTime = 0;
+    row.strings = &location.GetStrings();
 
-    VuRecording recording;
+    VuXMLRead(pNode, RecordingFields, row);
 
-    recording.iLastPlayedPosition = 0;
-    if (XMLUtils::GetString(pNode, "e2servicereference", strTmp))
-      recording.strRecordingId = strTmp;
+    VuRecording &recording = row.recording;
+    recording.strIconPath = location.GetStrings().Add(GetChannelIconPath(recording.strChannelName.c_str()));
+    recording.iDuration = row.strLength.empty() ? 0 : TimeStringToSeconds(row.strLength.c_str());
 
-    if (XMLUtils::GetString(pNode, "e2title", strTmp))
-      recording.strTitle = strTmp;
-    
-    if (XMLUtils::GetString(pNode, "e2description", strTmp))
-      recording.strPlotOutline = strTmp;
+    if (!row.strFilename.empty())
+    {
+      CStdString strTmp;
+      strTmp.Format("%sfile?file=%s", m_strURL.c_str(), URLEncodeInline(row.strFilename.c_str()).c_str());
+      recording.strStreamURL = location.GetStrings().Add(strTmp);
+    }
 
-    if (XMLUtils::GetString(pNode, "e2descriptionextended", strTmp))
-      recording.strPlot = strTmp;
-    
-    if (XMLUtils::GetString(pNode, "e2servicename", strTmp))
-      recording.strChannelName = strTmp;
+    location.Add(recording);
+
+    XBMC->Log(LOG_DEBUG, "%s loaded Recording entry '%s', start '%d', length '%d'", __FUNCTION__, recording.strTitle.c_str(), recording.startTime, recording.iDuration);
+  }
+
+  return true;
+}
 
-    recording.strIconPath = GetChannelIconPath(strTmp.c_str());
+PVR_ERROR Vu::DeleteRecording(const PVR_RECORDING &recinfo) 
+{
+  CStdString strTmp;
 
-    if (XMLUtils::GetInt(pNode, "e2time", iTmp)) 
-      recording.startTime = iTmp;
+  strTmp.Format("web/moviedelete?sRef=%s", URLEncodeInline(recinfo.strRecordingId));
 
-    if (XMLUtils::GetString(pNode, "e2length", strTmp)) 
+  CStdString strResult;
+  if(!SendSimpleCommand(strTmp.c_str(), strResult)) 
+    return PVR_ERROR_FAILED;
+
+  CLockObject lock(m_mutex);
+
+  for (unsigned int i = 0; i < m_recordingLocations.size(); i++)
+  {
+    if (m_recordingLocations[i]->Remove(recinfo.strRecordingId))
     {
-      iTmp = TimeStringToSeconds(strTmp.c_str());
-      recording.iDuration = iTmp;
+      m_iNumRecordings--;
+      break;
     }
-    else
-      recording.iDuration = 0;
+  }
 
-    if (XMLUtils::GetString(pNode, "e2filename", strTmp)) 
+  m_recordingReconcile.Request(time(NULL), RECONCILE_DELAY);
+  PVR->TriggerRecordingUpdate();
+
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVR_ERROR Vu::CallMenuHook(const PVR_MENUHOOK &menuhook, const PVR_MENUHOOK_DATA &item)
+{
+  switch (menuhook.iHookId)
+  {
+    case MENUHOOK_RECORDING_DELETE_TITLE:
+      return DeleteRecordingsByTitle(item.data.recording);
+    case MENUHOOK_TIMER_DELETE_TITLE:
+      return DeleteTimersByTitle(item.data.timer);
+    case MENUHOOK_MEMORY_USAGE:
+      return ShowMemoryUsage();
+  }
+
+  return PVR_ERROR_NOT_IMPLEMENTED;
+}
+
+void Vu::GetMemoryUsage(VuMemoryUsage &usage)
+{
+  CLockObject lock(m_mutex);
+
+  size_t iChannels = VuVectorBytes(m_channels) + VuVectorBytes(m_channelTags) + VuVectorBytes(m_channelIndex) + m_serviceRefs.GetMemorySize();
+  for (unsigned int i = 0; i < m_channels.size(); i++)
+  {
+    const VuChannel &channel = m_channels[i];
+    iChannels += VuStringBytes(channel.strGroupName) + VuStringBytes(channel.strChannelName) +
+                 VuStringBytes(channel.strServiceReference) + VuStringBytes(channel.strEncodedServiceReference) +
+                 VuStringBytes(channel.strStreamURL) + VuStringBytes(channel.strIconPath);
+  }
+  usage.iBytes[VU_MEMORY_CHANNELS] = iChannels;
+
+  size_t iGroups = VuVectorBytes(m_groups) + VuHashBytes(m_groupIndex);
+  for (unsigned int i = 0; i < m_groups.size(); i++)
+  {
+    // the name is stored a second time as key of m_groupIndex
+    const VuChannelGroup &group = m_groups[i];
+    iGroups += VuStringBytes(group.strServiceReference) + 2 * VuStringBytes(group.strGroupName) + VuVectorBytes(group.members);
+  }
+  usage.iBytes[VU_MEMORY_GROUPS] = iGroups;
+
+  size_t iInitialEPG = VuHashBytes(m_initialEPG) + m_initialEPGStrings.GetSize();
+  for (std::unordered_map<unsigned int, std::vector<VuEPGEntry> >::const_iterator it = m_initialEPG.begin(); it != m_initialEPG.end(); ++it)
+    iInitialEPG += VuVectorBytes(it->second);
+  usage.iBytes[VU_MEMORY_INITIAL_EPG] = iInitialEPG;
+
+  usage.iBytes[VU_MEMORY_TIMERS] = m_timers.GetMemorySize();
+
+  size_t iRecordings = VuVectorBytes(m_recordingLocations);
+  for (unsigned int i = 0; i < m_recordingLocations.size(); i++)
+    iRecordings += sizeof(VuRecordingLocation) + m_recordingLocations[i]->GetMemorySize();
+  usage.iBytes[VU_MEMORY_RECORDINGS] = iRecordings;
+
+  CLockObject epgLock(m_epgMutex);
+
+  size_t iEPG = VuVectorBytes(m_epg);
+  for (unsigned int i = 0; i < m_epg.size(); i++)
+    iEPG += m_epg[i].GetMemorySize();
+  usage.iBytes[VU_MEMORY_EPG] = iEPG;
+
+  usage.iBytes[VU_MEMORY_EPG_COLD_INDEX] = m_coldEPG.GetIndexSize();
+  usage.iDiskBytes = m_coldEPG.GetLiveSize();
+}
+
+void Vu::LogMemoryUsage(addon_log_t level, const VuMemoryUsage &usage)
+{
+  for (unsigned int i = 0; i < VU_MEMORY_POOL_COUNT; i++)
+    XBMC->Log(level, "%s %s: %u KB", __FUNCTION__, VuMemoryUsage::GetName((VU_MEMORY_POOL)i), (unsigned int)(usage.iBytes[i] / 1024));
+
+  XBMC->Log(level, "%s total: %u KB in memory, %u KB of EPG on disk", __FUNCTION__, (unsigned int)(usage.GetTotal() / 1024), (unsigned int)(usage.iDiskBytes / 1024));
+}
+
+PVR_ERROR Vu::ShowMemoryUsage()
+{
+  VuMemoryUsage usage;
+  GetMemoryUsage(usage);
+  LogMemoryUsage(LOG_INFO, usage);
+
+  char *strMessage = XBMC->GetLocalizedString(30503);
+  XBMC->QueueNotification(QUEUE_INFO, strMessage, (int)(usage.GetTotal() / 1024), (int)(usage.iBytes[VU_MEMORY_EPG] / 1024));
+  XBMC->FreeString(strMessage);
+
+  return PVR_ERROR_NO_ERROR;
+}
+
+unsigned int Vu::SendCommandBatch(std::vector<VuCommand> &commands)
+{
+  XBMC->Log(LOG_INFO, "%s Sending %u commands", __FUNCTION__, commands.size());
+
+  // refresh priority, so that the batch waits for the free slots of the request queue
+  VuCommandBatch batch(commands, [this](VuCommand &command)
+  {
+    return SendSimpleCommand(command.strCommand.c_str(), command.strResult, false, VU_REQUEST_REFRESH);
+  });
+  unsigned int iFailed = batch.Run(m_requestQueue.GetLimit());
+
+  if (iFailed > 0)
+  {
+    XBMC->Log(LOG_ERROR, "%s %u of %u commands failed", __FUNCTION__, iFailed, commands.size());
+
+    char *strMessage = XBMC->GetLocalizedString(30502);
+    XBMC->QueueNotification(QUEUE_ERROR, strMessage, iFailed, commands.size());
+    XBMC->FreeString(strMessage);
+  }
+
+  return iFailed;
+}
+
+PVR_ERROR Vu::DeleteRecordingsByTitle(const PVR_RECORDING &recinfo)
+{
+  std::vector<VuCommand> commands;
+  std::vector<std::string> recordingIds;
+  {
+    CLockObject lock(m_mutex);
+    for (unsigned int j = 0; j < m_recordingLocations.size(); j++)
     {
-      strTmp.Format("%sfile?file=%s", m_strURL.c_str(), URLEncodeInline(strTmp.c_str()));
-      recording.strStreamURL = strTmp;
+      const std::vector<VuRecording> &recordings = m_recordingLocations[j]->GetRecordings();
+      for (unsigned int i = 0; i < recordings.size(); i++)
+      {
+        if (strcmp(recordings[i].strTitle.c_str(), recinfo.strTitle) != 0)
+          continue;
+
+        CStdString strTmp;
+        strTmp.Format("web/moviedelete?sRef=%s", URLEncodeInline(recordings[i].strRecordingId.c_str()));
+        commands.push_back(VuCommand(strTmp));
+        recordingIds.push_back(recordings[i].strRecordingId.c_str());
+      }
     }
+  }
 
-    m_iNumRecordings++; 
-    iNumRecording++;
+  if (commands.empty())
+    return PVR_ERROR_NO_ERROR;
 
-    m_recordings.push_back(recording);
+  unsigned int iFailed = SendCommandBatch(commands);
 
-    XBMC->Log(LOG_DEBUG, "%s loaded Recording entry '%s', start '%d', length '%d'", __FUNCTION__, recording.strTitle.c_str(), recording.startTime, recording.iDuration);
+  CLockObject lock(m_mutex);
+  for (unsigned int j = 0; j < commands.size(); j++)
+  {
+    if (!commands[j].bOk)
+      continue;
+
+    for (unsigned int i = 0; i < m_recordingLocations.size(); i++)
+    {
+      if (m_recordingLocations[i]->Remove(recordingIds[j].c_str()))
+      {
+        m_iNumRecordings--;
+        break;
+      }
+    }
   }
 
-  XBMC->Log(LOG_INFO, "%s Loaded %u Recording Entries from folder '%s'", __FUNCTION__, iNumRecording, strRecordingFolder.c_str());
+  m_recordingReconcile.Request(time(NULL), RECONCILE_DELAY);
+  PVR->TriggerRecordingUpdate();
+
+  return (iFailed == 0) ? PVR_ERROR_NO_ERROR : PVR_ERROR_FAILED;
+}
 
+bool Vu::GetEncodedServiceReference(unsigned int iServiceRef, std::string &strEncoded)
+{
+  if (iServiceRef == SERVICE_REF_NONE)
+    return false;
+
+  VuStringRef strServiceReference = m_serviceRefs.Get(iServiceRef);
+  if (strServiceReference.empty())
+    return false;
+
+  VuURL::Encode(strServiceReference.c_str(), strServiceReference.length(), strEncoded);
   return true;
 }
 
-PVR_ERROR Vu::DeleteRecording(const PVR_RECORDING &recinfo) 
+PVR_ERROR Vu::DeleteTimersByTitle(const PVR_TIMER &timer)
 {
-  CStdString strTmp;
+  std::vector<VuCommand> commands;
+  std::vector<unsigned int> clientIndexes;
+  bool bRecording = false;
+  {
+    CLockObject lock(m_mutex);
+    m_timers.ForEach([&](const VuTimer &current)
+    {
+      if (current.strTitle.compare(timer.strTitle) != 0)
+        return;
 
-  strTmp.Format("web/moviedelete?sRef=%s", URLEncodeInline(recinfo.strRecordingId));
+      // the timer may be on a service outside the loaded bouquets
+      std::string strEncodedServiceReference;
+      if (!GetEncodedServiceReference(current.iServiceRef, strEncodedServiceReference))
+      {
+        XBMC->Log(LOG_ERROR, "%s No service reference for timer '%s'", __FUNCTION__, current.strTitle.c_str());
+        return;
+      }
 
-  CStdString strResult;
-  if(!SendSimpleCommand(strTmp, strResult)) 
-    return PVR_ERROR_FAILED;
+      CStdString strTmp;
+      strTmp.Format("web/timerdelete?sRef=%s&begin=%d&end=%d", strEncodedServiceReference.c_str(), current.startTime, current.endTime);
+      commands.push_back(VuCommand(strTmp));
+      clientIndexes.push_back(current.iClientIndex);
+      bRecording = bRecording || (current.state == PVR_TIMER_STATE_RECORDING);
+    });
+  }
 
-  PVR->TriggerRecordingUpdate();
+  if (commands.empty())
+    return PVR_ERROR_NO_ERROR;
 
-  return PVR_ERROR_NO_ERROR;
+  unsigned int iFailed = SendCommandBatch(commands);
+
+  CLockObject lock(m_mutex);
+  for (unsigned int j = 0; j < commands.size(); j++)
+  {
+    if (commands[j].bOk)
+      m_timers.Remove(clientIndexes[j]);
+  }
+
+  TimerEdited(bRecording);
+
+  return (iFailed == 0) ? PVR_ERROR_NO_ERROR : PVR_ERROR_FAILED;
 }
 
 PVR_ERROR Vu::UpdateTimer(const PVR_TIMER &timer)
@@ -1487,33 +2141,67 @@ PVR_ERROR Vu::UpdateTimer(const PVR_TIMER &timer)
   XBMC->Log(LOG_DEBUG, "%s timer channelid '%d'", __FUNCTION__, timer.iClientChannelUid);
 
   CStdString strTmp;
-  CStdString strServiceReference = m_channels.at(timer.iClientChannelUid-1).strServiceReference.c_str();  
 
-  unsigned int i=0;
+  CLockObject lock(m_mutex);
 
-  while (i<m_timers.size())
+  const VuTimer *existing = m_timers.Get(timer.iClientIndex);
+  if (!existing)
   {
-    if (m_timers.at(i).iClientIndex == timer.iClientIndex)
-      break;
-    else
-      i++;
+    XBMC->Log(LOG_ERROR, "%s Unknown timer, ClientIndex '%d'", __FUNCTION__, timer.iClientIndex);
+    return PVR_ERROR_INVALID_PARAMETERS;
   }
 
-  VuTimer &oldTimer = m_timers.at(i);
-  CStdString strOldServiceReference = m_channels.at(oldTimer.iChannelId-1).strServiceReference.c_str();  
+  VuTimer oldTimer = *existing;
+  std::string strOldEncodedServiceReference;
+  if (!GetEncodedServiceReference(oldTimer.iServiceRef, strOldEncodedServiceReference))
+  {
+    XBMC->Log(LOG_ERROR, "%s No service reference for timer '%s'", __FUNCTION__, oldTimer.strTitle.c_str());
+    return PVR_ERROR_FAILED;
+  }
   XBMC->Log(LOG_DEBUG, "%s old timer channelid '%d'", __FUNCTION__, oldTimer.iChannelId);
 
+  // the timer stays on its service unless it is moved to another loaded channel
+  int iChannelId = oldTimer.iChannelId;
+  unsigned int iServiceRef = oldTimer.iServiceRef;
+  if (timer.iClientChannelUid > 0 && (unsigned int)timer.iClientChannelUid <= m_channels.size())
+  {
+    iChannelId = timer.iClientChannelUid;
+    iServiceRef = m_channels.at(timer.iClientChannelUid-1).iServiceRef;
+  }
+
+  std::string strEncodedServiceReference;
+  if (!GetEncodedServiceReference(iServiceRef, strEncodedServiceReference))
+  {
+    XBMC->Log(LOG_ERROR, "%s No service reference for channel '%d'", __FUNCTION__, timer.iClientChannelUid);
+    return PVR_ERROR_FAILED;
+  }
+
   int iDisabled = 0;
   if (timer.state == PVR_TIMER_STATE_CANCELLED)
     iDisabled = 1;
 
-  strTmp.Format("web/timerchange?sRef=%s&begin=%d&end=%d&name=%s&eventID=&description=%s&tags=&afterevent=3&eit=0&disabled=%d&justplay=0&repeated=%d&channelOld=%s&beginOld=%d&endOld=%d&deleteOldOnSave=1", URLEncodeInline(strServiceReference.c_str()), timer.startTime, timer.endTime, URLEncodeInline(timer.strTitle), URLEncodeInline(timer.strSummary), iDisabled, timer.iWeekdays, URLEncodeInline(strOldServiceReference.c_str()), oldTimer.startTime, oldTimer.endTime  );
+  strTmp.Format("web/timerchange?sRef=%s&begin=%d&end=%d&name=%s&eventID=&description=%s&tags=&afterevent=3&eit=0&disabled=%d&justplay=0&repeated=%d&channelOld=%s&beginOld=%d&endOld=%d&deleteOldOnSave=1", strEncodedServiceReference.c_str(), timer.startTime, timer.endTime, URLEncodeInline(timer.strTitle), URLEncodeInline(timer.strSummary), iDisabled, timer.iWeekdays, strOldEncodedServiceReference.c_str(), oldTimer.startTime, oldTimer.endTime  );
   
   CStdString strResult;
-  if(!SendSimpleCommand(strTmp, strResult))
+  if(!SendSimpleCommand(strTmp.c_str(), strResult))
     return PVR_ERROR_SERVER_ERROR;
 
-  TimerUpdates();
+  oldTimer.strTitle = timer.strTitle;
+  oldTimer.strPlot = timer.strSummary;
+  oldTimer.iChannelId = iChannelId;
+  oldTimer.iServiceRef = iServiceRef;
+  oldTimer.startTime = timer.startTime;
+  oldTimer.endTime = timer.endTime;
+  oldTimer.iWeekdays = timer.iWeekdays;
+  oldTimer.bRepeating = (timer.iWeekdays != 0);
+  oldTimer.iEpgID = 0; // timerchange drops the event id, see eit=0 above
+  if (iDisabled)
+    oldTimer.state = PVR_TIMER_STATE_CANCELLED;
+  else
+    oldTimer.state = (timer.startTime <= time(NULL)) ? PVR_TIMER_STATE_RECORDING : PVR_TIMER_STATE_SCHEDULED;
+  m_timers.Update(timer.iClientIndex, oldTimer);
+
+  TimerEdited(false);
 
   return PVR_ERROR_NO_ERROR;
 }
@@ -1620,14 +2308,21 @@ unsigned int Vu::GetNumChannelGroups()
   return m_iNumChannelGroups;
 }
 
+VuChannelGroup *Vu::GetGroup(const std::string &strGroupName)
+{
+  std::unordered_map<std::string, unsigned int>::const_iterator it = m_groupIndex.find(strGroupName);
+  if (it == m_groupIndex.end())
+    return NULL;
+
+  return &m_groups.at(it->second);
+}
+
 CStdString Vu::GetGroupServiceReference(CStdString strGroupName)  
 {
-  for (int i = 0;i<m_iNumChannelGroups;  i++) 
-  {
-    VuChannelGroup &myGroup = m_groups.at(i);
-    if (!strGroupName.compare(myGroup.strGroupName))
-      return myGroup.strServiceReference;
-  }
+  VuChannelGroup *myGroup = GetGroup(strGroupName);
+  if (myGroup)
+    return myGroup->strServiceReference;
+
   return "error";
 }
 
@@ -1642,24 +2337,29 @@ PVR_ERROR Vu::GetChannelGroupMembers(ADDON_HANDLE handle, const PVR_CHANNEL_GROU
   }
 
   XBMC->Log(LOG_DEBUG, "%s - group '%s'", __FUNCTION__, group.strGroupName);
-  CStdString strTmp = group.strGroupName;
-  for (unsigned int i = 0;i<m_channels.size();  i++) 
+
+  VuChannelGroup *myGroup = GetGroup(group.strGroupName);
+  if (!myGroup)
   {
-    VuChannel &myChannel = m_channels.at(i);
-    if (!strTmp.compare(myChannel.strGroupName)) 
-    {
-      PVR_CHANNEL_GROUP_MEMBER tag;
-      memset(&tag,0 , sizeof(PVR_CHANNEL_GROUP_MEMBER));
+    XBMC->Log(LOG_ERROR, "%s - unknown group '%s'", __FUNCTION__, group.strGroupName);
+    return PVR_ERROR_NO_ERROR;
+  }
 
-      strncpy(tag.strGroupName, group.strGroupName, sizeof(tag.strGroupName));
-      tag.iChannelUniqueId = myChannel.iUniqueId;
-      tag.iChannelNumber   = myChannel.iChannelNumber;
+  PVR_CHANNEL_GROUP_MEMBER tag;
+  memset(&tag,0 , sizeof(PVR_CHANNEL_GROUP_MEMBER));
+  strncpy(tag.strGroupName, group.strGroupName, sizeof(tag.strGroupName));
 
-      XBMC->Log(LOG_DEBUG, "%s - add channel %s (%d) to group '%s' channel number %d",
-          __FUNCTION__, myChannel.strChannelName.c_str(), tag.iChannelUniqueId, group.strGroupName, myChannel.iChannelNumber);
+  for (unsigned int i = 0;i<myGroup->members.size();  i++) 
+  {
+    VuChannel &myChannel = m_channels.at(myGroup->members[i]);
 
-      PVR->TransferChannelGroupMember(handle, &tag);
-    }
+    tag.iChannelUniqueId = myChannel.iUniqueId;
+    tag.iChannelNumber   = myChannel.iChannelNumber;
+
+    XBMC->Log(LOG_DEBUG, "%s - add channel %s (%d) to group '%s' channel number %d",
+        __FUNCTION__, myChannel.strChannelName.c_str(), tag.iChannelUniqueId, group.strGroupName, myChannel.iChannelNumber);
+
+    PVR->TransferChannelGroupMember(handle, &tag);
   }
   return PVR_ERROR_NO_ERROR;
 }
@@ -1723,13 +2423,11 @@ bool Vu::SwitchChannel(const PVR_CHANNEL &channel)
   if (g_bZap)
   {
     // Zapping is set to true, so send the zapping command to the PVR box 
-    CStdString strServiceReference = m_channels.at(channel.iUniqueId-1).strServiceReference.c_str();
-
-    CStdString strTmp;
-    strTmp.Format("web/zap?sRef=%s", URLEncodeInline(strServiceReference));
+    VuURL command;
+    command.Append("web/zap?sRef=").Append(m_channels.at(channel.iUniqueId-1).strEncodedServiceReference);
 
     CStdString strResult;
-    if(!SendSimpleCommand(strTmp, strResult))
+    if(!SendSimpleCommand(command.c_str(), strResult))
       return false;
   
   }
@@ -1746,7 +2444,7 @@ void Vu::SendPowerstate()
   strTmp.Format("web/powerstate?newstate=1");
 
   CStdString strResult;
-  SendSimpleCommand(strTmp, strResult, true); 
+  SendSimpleCommand(strTmp.c_str(), strResult, true); 
 }
 
 bool Vu::GetDeviceInfo()
@@ -1755,7 +2453,7 @@ bool Vu::GetDeviceInfo()
   url.Format("%s%s", m_strURL.c_str(), "web/deviceinfo"); 
 
   CStdString strXML;
-  strXML = GetHttpXML(url);
+  strXML = GetHttpXML(url.c_str());
   
   TiXmlDocument xmlDoc;
   if (!xmlDoc.Parse(strXML))
@@ -1807,6 +2505,10 @@ bool Vu::GetDeviceInfo()
   m_strWebIfVersion = strTmp.c_str();
   XBMC->Log(LOG_NOTICE, "%s - E2WebIfVersion: %s", __FUNCTION__, m_strWebIfVersion.c_str());
 
+  // OpenWebif reports itself as "OWIF <version>" and also serves the JSON api
+  m_bUseJSON = (m_strWebIfVersion.compare(0, 4, "OWIF") == 0);
+  XBMC->Log(LOG_NOTICE, "%s - Using the %s webinterface", __FUNCTION__, m_bUseJSON ? "JSON" : "XML");
+
   // Get DeviceName
   if (!XMLUtils::GetString(pElem, "e2devicename", strTmp)) 
   {
@@ -1819,65 +2521,10 @@ bool Vu::GetDeviceInfo()
   return true;
 }
 
-const char SAFE[256] =
-{
-    /*      0 1 2 3  4 5 6 7  8 9 A B  C D E F */
-    /* 0 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* 1 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* 2 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* 3 */ 1,1,1,1, 1,1,1,1, 1,1,0,0, 0,0,0,0,
-
-    /* 4 */ 0,1,1,1, 1,1,1,1, 1,1,1,1, 1,1,1,1,
-    /* 5 */ 1,1,1,1, 1,1,1,1, 1,1,1,0, 0,0,0,0,
-    /* 6 */ 0,1,1,1, 1,1,1,1, 1,1,1,1, 1,1,1,1,
-    /* 7 */ 1,1,1,1, 1,1,1,1, 1,1,1,0, 0,0,0,0,
-
-    /* 8 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* 9 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* A */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* B */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-
-    /* C */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* D */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* E */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
-    /* F */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0
-};
-
-
 CStdString Vu::URLEncodeInline(const CStdString& sSrc) 
 {
-  const char DEC2HEX[16 + 1] = "0123456789ABCDEF";
-  const unsigned char * pSrc = (const unsigned char *)sSrc.c_str();
-  const int SRC_LEN = sSrc.length();
-  unsigned char * const pStart = new unsigned char[SRC_LEN * 3];
-  unsigned char * pEnd = pStart;
-  const unsigned char * const SRC_END = pSrc + SRC_LEN;
-
-  for (; pSrc < SRC_END; ++pSrc)
-  {
-    if (SAFE[*pSrc])
-      *pEnd++ = *pSrc;
-    else
-    {
-      // escape this char
-      *pEnd++ = '%';
-      *pEnd++ = DEC2HEX[*pSrc >> 4];
-      *pEnd++ = DEC2HEX[*pSrc & 0x0F];
-    }
-  }
-
-  std::string sResult((char *)pStart, (char *)pEnd);
-  delete [] pStart;
-  return sResult;
-}
-
-int Vu::GetRecordingIndex(CStdString strStreamURL)  
-{
-  for (unsigned int i = 0;i<m_recordings.size();  i++) 
-  {
-    if (!strStreamURL.compare(m_recordings[i].strStreamURL))
-      return i;
-  }
-  return -1;
+  std::string strResult;
+  VuURL::Encode(sSrc.c_str(), sSrc.length(), strResult);
+  return strResult;
 }
 
@@ -25,45 +25,60 @@
 #include "client.h"
 #include "platform/threads/threads.h"
 #include "tinyxml.h"
+#include "VuEPG.h"
+#include "VuEPGStore.h"
+#include "VuScheduler.h"
+#include "VuRequestQueue.h"
+#include "VuResponseCache.h"
+#include "VuServiceRef.h"
+#include "VuURL.h"
+#include "VuCommandBatch.h"
+#include "VuTimers.h"
+#include "VuRecordings.h"
+#include <unordered_map>
+#include <memory>
     
 #define CHANNELDATAVERSION  2
 
+// context menu entries, see Vu::CallMenuHook
+#define MENUHOOK_RECORDING_DELETE_TITLE  1
+#define MENUHOOK_TIMER_DELETE_TITLE  2
+#define MENUHOOK_MEMORY_USAGE  3
+
+// seconds between the memory usage reports in the debug log
+#define MEMORY_REPORT_INTERVAL  (60 * 60)
+
 class CCurlFile
 {
 public:
   CCurlFile(void) {};
   ~CCurlFile(void) {};
 
-  bool Get(const std::string &strURL, std::string &strResult);
+  bool Get(const char *strURL, std::string &strResult);
 };
 
 
-typedef enum VU_UPDATE_STATE
-{
-    VU_UPDATE_STATE_NONE,
-    VU_UPDATE_STATE_FOUND,
-    VU_UPDATE_STATE_UPDATED,
-    VU_UPDATE_STATE_NEW
-} VU_UPDATE_STATE;
-
-struct VuEPGEntry 
+struct VuChannelGroup 
 {
-  int iEventId;
   std::string strServiceReference;
-  std::string strTitle;
-  int iChannelId;
-  time_t startTime;
-  time_t endTime;
-  std::string strPlotOutline;
-  std::string strPlot;
+  std::string strGroupName;
+  int iGroupState;
+  bool bInitialEPGLoaded;
+  time_t iInitialEPGRetry; // no new attempt to load the initial EPG before
+  std::vector<unsigned int> members; // indices into the canonical channel table
+
+  VuChannelGroup()
+  {
+    iGroupState = 0;
+    bInitialEPGLoaded = false;
+    iInitialEPGRetry = 0;
+  }
 };
 
-struct VuChannelGroup 
+struct VuService
 {
   std::string strServiceReference;
-  std::string strGroupName;
-  int iGroupState;
-  std::vector<VuEPGEntry> initialEPG;
+  std::string strServiceName;
 };
 
 struct VuChannel
@@ -72,77 +87,15 @@ struct VuChannel
   bool bInitialEPG;
   int iUniqueId;
   int iChannelNumber;
-  std::string strGroupName;
+  std::string strGroupName; // first bouquet the service was found in
   std::string strChannelName;
   std::string strServiceReference;
+  unsigned int iServiceRef; // id of strServiceReference in Vu::m_serviceRefs
+  std::string strEncodedServiceReference; // percent-encoded for webinterface URLs
   std::string strStreamURL;
   std::string strIconPath;
 };
 
-struct VuTimer
-{
-  std::string strTitle;
-  std::string strPlot;
-  int iChannelId;
-  time_t startTime;
-  time_t endTime;
-  bool bRepeating; 
-  int iWeekdays;
-  int iEpgID;
-  PVR_TIMER_STATE state; 
-  int iUpdateState;
-  unsigned int iClientIndex;
-
-  VuTimer()
-  {
-    iUpdateState = VU_UPDATE_STATE_NEW;
-  }
-  
-  bool like(const VuTimer &right) const
-  {
-    bool bChanged = true;
-    bChanged = bChanged && (startTime == right.startTime); 
-    bChanged = bChanged && (endTime == right.endTime); 
-    bChanged = bChanged && (iChannelId == right.iChannelId); 
-    bChanged = bChanged && (bRepeating == right.bRepeating); 
-    bChanged = bChanged && (iWeekdays == right.iWeekdays); 
-    bChanged = bChanged && (iEpgID == right.iEpgID); 
-
-    return bChanged;
-  }
-  
-  bool operator==(const VuTimer &right) const
-  {
-    bool bChanged = true;
-    bChanged = bChanged && (startTime == right.startTime); 
-    bChanged = bChanged && (endTime == right.endTime); 
-    bChanged = bChanged && (iChannelId == right.iChannelId); 
-    bChanged = bChanged && (bRepeating == right.bRepeating); 
-    bChanged = bChanged && (iWeekdays == right.iWeekdays); 
-    bChanged = bChanged && (iEpgID == right.iEpgID); 
-    bChanged = bChanged && (state == right.state); 
-    bChanged = bChanged && (! strTitle.compare(right.strTitle));
-    bChanged = bChanged && (! strPlot.compare(right.strPlot));
-
-    return bChanged;
-  }
-};
-
-struct VuRecording
-{
-  std::string strRecordingId;
-  time_t startTime;
-  int iDuration;
-  int iLastPlayedPosition;
-  std::string strTitle;
-  std::string strStreamURL;
-  std::string strPlot;
-  std::string strPlotOutline;
-  std::string strChannelName;
-  std::string strDirectory;
-  std::string strIconPath;
-};
- 
 class Vu  : public PLATFORM::CThread
 {
 private:
@@ -154,38 +107,81 @@ private:
   std::string m_strImageVersion;
   std::string m_strWebIfVersion;
   bool  m_bIsConnected;
+  bool  m_bUseJSON; // the box runs OpenWebif, use its JSON api instead of the XML webinterface
   std::string m_strServerName;
   std::string m_strURL;
   int m_iNumRecordings;
+  bool m_bRecordingsLoaded; // every location was loaded once, GetRecordings can skip the movielist requests
   int m_iNumChannelGroups;
   int m_iCurrentChannel;
-  unsigned int m_iUpdateTimer;
   std::vector<VuChannel> m_channels;
-  std::vector<VuTimer> m_timers;
-  std::vector<VuRecording> m_recordings;
+  std::vector<PVR_CHANNEL> m_channelTags; // m_channels as handed to Kodi, built by the first GetChannels after a load
+  VuServiceRefTable m_serviceRefs;
+  std::vector<unsigned int> m_channelIndex; // service reference id -> m_channels index + 1, 0 if the service is no channel
+  VuTimerMap m_timers;
+  std::vector<std::unique_ptr<VuRecordingLocation> > m_recordingLocations;
   std::vector<VuChannelGroup> m_groups;
-  std::vector<std::string> m_locations;
-  unsigned int m_iClientIndexCounter;
+  std::unordered_map<std::string, unsigned int> m_groupIndex; // group name -> m_groups index
+  std::unordered_map<unsigned int, std::vector<VuEPGEntry> > m_initialEPG; // service reference id -> now/next events
+  VuStringArena m_initialEPGStrings;
+  std::vector<VuChannelEPG> m_epg; // EPG per m_channels index
+  VuChannelLRU m_descriptionLRU; // channels of m_epg holding descriptions, guarded by m_epgMutex
+  VuChannelLRU m_epgLRU; // channels of m_epg holding events, guarded by m_epgMutex
+  std::vector<time_t> m_epgRetry; // m_epg index -> earliest refresh after a failed one, guarded by m_epgMutex
+  VuEPGColdStore m_coldEPG; // events of m_epg beyond the hot window, guarded by m_epgMutex
 
   PLATFORM::CMutex m_mutex;
+  PLATFORM::CMutex m_epgMutex;
+  VuRequestQueue m_requestQueue;
+  VuResponseCache m_responseCache;
+  VuTimerBoundaries m_timerBoundaries;
+  VuDeferredRun m_timerReconcile; // reload of the timers after local edits
+  VuDeferredRun m_recordingReconcile; // reload of the recordings after local edits
   PLATFORM::CCondition<bool> m_started;
 
   bool m_bUpdating;
 
   // functions
-  CStdString GetHttpXML(CStdString& url);
+  CStdString GetHttpXML(const char *url, VU_REQUEST_PRIORITY priority = VU_REQUEST_REFRESH);
+  bool FetchURL(const char *url, std::string& strResult, VU_REQUEST_PRIORITY priority);
   int GetChannelNumber(CStdString strServiceReference);
+  int GetChannelNumberById(unsigned int iServiceRef);
   CStdString GetChannelIconPath(CStdString strChannelName);
-  bool SendSimpleCommand(const CStdString& strCommandURL, CStdString& strResult, bool bIgnoreResult = false);
+  bool SendSimpleCommand(const char *strCommandURL, CStdString& strResult, bool bIgnoreResult = false, VU_REQUEST_PRIORITY priority = VU_REQUEST_INTERACTIVE);
   CStdString GetGroupServiceReference(CStdString strGroupName);
-  bool LoadChannels(CStdString strServerReference, CStdString strGroupName);
+  VuChannelGroup *GetGroup(const std::string &strGroupName);
+  bool LoadServices(const std::string &strBouquet, std::vector<VuService> &services);
+  bool LoadChannels(VuChannelGroup &group);
   bool LoadChannels();
+  bool LoadEPGForChannel(const VuChannel &channel, time_t iStart, time_t iEnd, std::vector<VuEPGEntry> &entries, VuStringArena &arena, VU_REQUEST_PRIORITY priority = VU_REQUEST_REFRESH);
+  bool LoadEPGEvents(const char *url, std::vector<VuEPGEntry> &entries, VuStringArena &arena, VU_REQUEST_PRIORITY priority);
+  void TransferEPGEntry(ADDON_HANDLE handle, const VuEPGEntry &entry, int iChannelNumber);
+  VU_TASK_RESULT RefreshNextEPG();
+  void TouchEPG(unsigned int iChannel);
+  void KeepDescriptions(unsigned int iChannel);
+  void SpillColdEPG(unsigned int iChannel, time_t iStart, time_t iEnd);
+  unsigned int GetEPGFingerprint(unsigned int iChannel);
+  void CompactColdEPG();
+  VU_TASK_RESULT PromoteEPGTask();
+  VU_TASK_RESULT UpdateTimersTask();
+  VU_TASK_RESULT UpdateRecordingsTask();
+  VU_TASK_RESULT CleanupTimersTask();
+  void LogMemoryUsage(addon_log_t level, const VuMemoryUsage &usage);
   bool LoadChannelGroups();
   bool LoadLocations();
-  std::vector<VuTimer> LoadTimers();
-  void TimerUpdates();
+  bool LoadTimers(std::vector<VuTimer> &timers, VU_REQUEST_PRIORITY priority = VU_REQUEST_REFRESH);
+  bool TimerUpdates(VU_REQUEST_PRIORITY priority = VU_REQUEST_REFRESH);
+  void UpdateTimerBoundaries();
+  void TimerEdited(bool bRecordingsChanged);
+  unsigned int SendCommandBatch(std::vector<VuCommand> &commands);
+  bool GetEncodedServiceReference(unsigned int iServiceRef, std::string &strEncoded);
+  PVR_ERROR DeleteRecordingsByTitle(const PVR_RECORDING &recinfo);
+  PVR_ERROR DeleteTimersByTitle(const PVR_TIMER &timer);
   bool GetDeviceInfo();
-  int GetRecordingIndex(CStdString);
+  // returns whether every location was loaded
+  bool RefreshRecordings(VU_REQUEST_PRIORITY priority, bool &bAnyChanged);
+  bool LoadRecordingLocation(VuRecordingLocation &location, bool &bChanged, VU_REQUEST_PRIORITY priority);
+  bool ParseRecordingsXML(const std::string &strXML, VuRecordingLocation &location);
 
   // helper functions
   static long TimeStringToSeconds(const CStdString &timeString);
@@ -194,8 +190,14 @@ private:
   bool CheckForChannelUpdate();
   std::string& Escape(std::string &s, std::string from, std::string to);
   CStdString URLEncodeInline(const CStdString& sSrc);
-  bool IsInRecordingFolder(CStdString);
   void TransferRecordings(ADDON_HANDLE handle);
+  static PVR_TIMER_STATE GetTimerState(int iState, int iDisabled, bool bCancelled);
+
+  // OpenWebif JSON api, see VuDataJSON.cpp
+  bool ParseServicesJSON(std::string &strJSON, std::vector<VuService> &services);
+  bool ParseEventsJSON(std::string &strJSON, std::vector<VuEPGEntry> &entries, VuStringArena &arena);
+  bool ParseTimersJSON(std::string &strJSON, std::vector<VuTimer> &timers);
+  int ParseRecordingsJSON(std::string &strJSON, VuRecordingLocation &location);
 
 protected:
   virtual void *Process(void);
@@ -217,10 +219,12 @@ public:
   PVR_ERROR AddTimer(const PVR_TIMER &timer);
   PVR_ERROR UpdateTimer(const PVR_TIMER &timer);
   PVR_ERROR DeleteTimer(const PVR_TIMER &timer);
-  bool GetRecordingFromLocation(CStdString strRecordingFolder);
   unsigned int GetRecordingsAmount();
   PVR_ERROR    GetRecordings(ADDON_HANDLE handle);
   PVR_ERROR    DeleteRecording(const PVR_RECORDING &recinfo);
+  PVR_ERROR    CallMenuHook(const PVR_MENUHOOK &menuhook, const PVR_MENUHOOK_DATA &item);
+  void         GetMemoryUsage(VuMemoryUsage &usage);
+  PVR_ERROR    ShowMemoryUsage();
   unsigned int GetNumChannelGroups(void);
   PVR_ERROR    GetChannelGroups(ADDON_HANDLE handle);
   PVR_ERROR    GetChannelGroupMembers(ADDON_HANDLE handle, const PVR_CHANNEL_GROUP &group);
@@ -0,0 +1,186 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "VuData.h"
+#include "VuDataSchema.h"
+#include "VuJSON.h"
+#include "client.h"
+
+using namespace ADDON;
+
+// parses strJSON and looks up the array the api returns its records in,
+// array is NULL if the response has no such array
+static bool ParseArray(VuJSONDocument &doc, std::string &strJSON, const char *strKey, const VuJSONValue *&array, const char *strFunction)
+{
+  array = NULL;
+
+  if (!doc.Parse(strJSON))
+  {
+    XBMC->Log(LOG_DEBUG, "%s Unable to parse JSON", strFunction);
+    return false;
+  }
+
+  array = doc.Get(doc.Root(), strKey);
+
+  if (!array || array->type != VU_JSON_ARRAY)
+  {
+    XBMC->Log(LOG_DEBUG, "%s Could not find '%s' array!", strFunction, strKey);
+    array = NULL;
+  }
+
+  return true;
+}
+
+bool Vu::ParseServicesJSON(std::string &strJSON, std::vector<VuService> &services)
+{
+  VuJSONDocument doc;
+  const VuJSONValue *array;
+  if (!ParseArray(doc, strJSON, "services", array, __FUNCTION__) || !array)
+    return false;
+
+  for (const VuJSONValue *node = doc.FirstChild(array); node != NULL; node = doc.NextSibling(array, node))
+  {
+    VuService service;
+
+    if (!VuJSONRead(doc, node, ServiceFields, service))
+      continue;
+
+    // Check whether the current element is not just a label
+    VuServiceRef ref;
+    if (VuServiceRef::Parse(service.strServiceReference, ref) && ref.IsMarker())
+      continue;
+
+    services.push_back(service);
+  }
+
+  return true;
+}
+
+bool Vu::ParseEventsJSON(std::string &strJSON, std::vector<VuEPGEntry> &entries, VuStringArena &arena)
+{
+  VuJSONDocument doc;
+  const VuJSONValue *array;
+  if (!ParseArray(doc, strJSON, "events", array, __FUNCTION__))
+    return false;
+
+  if (!array)
+    // Not an error as the EPG could be empty for this channel
+    return true;
+
+  for (const VuJSONValue *node = doc.FirstChild(array); node != NULL; node = doc.NextSibling(array, node))
+  {
+    VuEPGRow row;
+    row.entry.iChannelId = -1;
+    row.entry.iServiceRef = SERVICE_REF_NONE;
+    row.strings = &arena;
+    row.serviceRefs = &m_serviceRefs;
+
+    if (!VuJSONRead(doc, node, EPGFields, row))
+      continue;
+
+    VuEPGEntry &entry = row.entry;
+    entry.endTime = entry.startTime + row.iDuration;
+
+    entries.push_back(entry);
+
+    XBMC->Log(LOG_DEBUG, "%s loaded EPG entry '%d:%s' start '%d' end '%d'", __FUNCTION__, entry.iEventId, entry.strTitle.c_str(), entry.startTime, entry.endTime);
+  }
+
+  return true;
+}
+
+bool Vu::ParseTimersJSON(std::string &strJSON, std::vector<VuTimer> &timers)
+{
+  VuJSONDocument doc;
+  const VuJSONValue *array;
+  if (!ParseArray(doc, strJSON, "timers", array, __FUNCTION__) || !array)
+    return false;
+
+  for (const VuJSONValue *node = doc.FirstChild(array); node != NULL; node = doc.NextSibling(array, node))
+  {
+    VuTimerRow row;
+    row.timer.iChannelId = -1;
+    row.timer.iServiceRef = SERVICE_REF_NONE;
+    row.serviceRefs = &m_serviceRefs;
+    row.timer.iWeekdays = 0;
+    row.timer.iEpgID = 0;
+    row.bCancelled = false;
+
+    if (!VuJSONRead(doc, node, TimerFields, row))
+      continue;
+
+    VuTimer &timer = row.timer;
+    XBMC->Log(LOG_DEBUG, "%s Processing timer '%s'", __FUNCTION__, timer.strTitle.c_str());
+
+    if (timer.iServiceRef != SERVICE_REF_NONE)
+      timer.iChannelId = GetChannelNumberById(timer.iServiceRef);
+
+    timer.bRepeating = (timer.iWeekdays != 0);
+    timer.state = GetTimerState(row.iState, row.iDisabled, row.bCancelled);
+
+    timers.push_back(timer);
+
+    XBMC->Log(LOG_INFO, "%s fetched Timer entry '%s', begin '%d', end '%d'", __FUNCTION__, timer.strTitle.c_str(), timer.startTime, timer.endTime);
+  }
+
+  return true;
+}
+
+int Vu::ParseRecordingsJSON(std::string &strJSON, VuRecordingLocation &location)
+{
+  VuJSONDocument doc;
+  const VuJSONValue *array;
+  if (!ParseArray(doc, strJSON, "movies", array, __FUNCTION__) || !array)
+    return -1;
+
+  int iNumRecording = 0;
+
+  for (const VuJSONValue *node = doc.FirstChild(array); node != NULL; node = doc.NextSibling(array, node))
+  {
+    VuRecordingRow row;
+    row.recording.iLastPlayedPosition = 0;
+    row.recording.startTime = 0;
+    row.strings = &location.GetStrings();
+
+    if (!VuJSONRead(doc, node, RecordingFields, row))
+      continue;
+
+    VuRecording &recording = row.recording;
+    recording.strIconPath = location.GetStrings().Add(GetChannelIconPath(recording.strChannelName.c_str()));
+    recording.iDuration = row.strLength.empty() ? 0 : TimeStringToSeconds(row.strLength.c_str());
+
+    if (!row.strFilename.empty())
+    {
+      CStdString strURL;
+      strURL.Format("%sfile?file=%s", m_strURL.c_str(), URLEncodeInline(row.strFilename.c_str()).c_str());
+      recording.strStreamURL = location.GetStrings().Add(strURL);
+    }
+
+    iNumRecording++;
+
+    location.Add(recording);
+
+    XBMC->Log(LOG_DEBUG, "%s loaded Recording entry '%s', start '%d', length '%d'", __FUNCTION__, recording.strTitle.c_str(), recording.startTime, recording.iDuration);
+  }
+
+  return iNumRecording;
+}
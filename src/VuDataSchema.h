@@ -0,0 +1,62 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include "VuData.h"
+#include "VuXMLSchema.h"
+
+/*
+ * The e2 webinterface records, with the values that are only needed while
+ * loading, and their fields as the XML and the JSON loaders read them.
+ * The tables are defined in VuData.cpp.
+ */
+
+struct VuEPGRow
+{
+  VuEPGEntry entry;
+  int iDuration;
+  VuStringArena *strings;
+  VuServiceRefTable *serviceRefs;
+};
+
+struct VuTimerRow
+{
+  VuTimer timer;
+  VuServiceRefTable *serviceRefs;
+  int iState;
+  int iDisabled;
+  bool bCancelled;
+};
+
+struct VuRecordingRow
+{
+  VuRecording recording;
+  std::string strLength;
+  std::string strFilename;
+  VuStringArena *strings;
+};
+
+extern const VuXMLField<VuService> ServiceFields[2];
+extern const VuXMLField<VuEPGRow> EPGFields[7];
+extern const VuXMLField<VuTimerRow> TimerFields[10];
+extern const VuXMLField<VuRecordingRow> RecordingFields[8];
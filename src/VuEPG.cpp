@@ -0,0 +1,381 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuEPG.h"
+#include <algorithm>
+#include <unordered_set>
+
+static bool EntryStartsBefore(const VuEPGEntry &left, const VuEPGEntry &right)
+{
+  return left.startTime < right.startTime;
+}
+
+static bool EntryStartsBeforeTime(const VuEPGEntry &entry, time_t iTime)
+{
+  return entry.startTime < iTime;
+}
+
+// 32 bit FNV-1a
+static unsigned int HashBytes(unsigned int iHash, const void *pData, size_t iLength)
+{
+  const unsigned char *p = (const unsigned char *)pData;
+  for (size_t i = 0; i < iLength; i++)
+  {
+    iHash ^= p[i];
+    iHash *= 16777619u;
+  }
+  return iHash;
+}
+
+// adds [iStart, iEnd) to a sorted set of non-overlapping ranges
+static void AddRange(std::vector<VuTimeRange> &ranges, time_t iStart, time_t iEnd)
+{
+  std::vector<VuTimeRange> result;
+  result.reserve(ranges.size() + 1);
+
+  unsigned int i = 0;
+  for (; i < ranges.size() && ranges[i].second < iStart; i++)
+    result.push_back(ranges[i]);
+
+  // merge every range touching [iStart, iEnd)
+  for (; i < ranges.size() && ranges[i].first <= iEnd; i++)
+  {
+    iStart = std::min(iStart, ranges[i].first);
+    iEnd = std::max(iEnd, ranges[i].second);
+  }
+  result.push_back(VuTimeRange(iStart, iEnd));
+
+  for (; i < ranges.size(); i++)
+    result.push_back(ranges[i]);
+
+  ranges.swap(result);
+}
+
+static void RemoveRange(std::vector<VuTimeRange> &ranges, time_t iStart, time_t iEnd)
+{
+  std::vector<VuTimeRange> result;
+  result.reserve(ranges.size() + 1);
+
+  for (unsigned int i = 0; i < ranges.size(); i++)
+  {
+    const VuTimeRange &range = ranges[i];
+    if (range.second <= iStart || range.first >= iEnd)
+    {
+      result.push_back(range);
+      continue;
+    }
+
+    if (range.first < iStart)
+      result.push_back(VuTimeRange(range.first, iStart));
+    if (range.second > iEnd)
+      result.push_back(VuTimeRange(iEnd, range.second));
+  }
+
+  ranges.swap(result);
+}
+
+VuChannelEPG::VuChannelEPG(void)
+{
+  m_iLastUpdate = 0;
+  m_iLastFullUpdate = 0;
+  UpdateFingerprint();
+}
+
+void VuChannelEPG::Merge(std::vector<VuEPGEntry> &entries, VuStringArena &arena, time_t iStart, time_t iEnd)
+{
+  std::unordered_set<int> newIds;
+  for (unsigned int i = 0; i < entries.size(); i++)
+    newIds.insert(entries[i].iEventId);
+
+  // the backend answer replaces everything we knew about the fetched range
+  std::vector<VuEPGEntry> events;
+  events.reserve(m_events.size() + entries.size());
+  for (unsigned int i = 0; i < m_events.size(); i++)
+  {
+    const VuEPGEntry &entry = m_events[i];
+    if (entry.startTime >= iStart && entry.startTime < iEnd)
+      continue;
+    if (newIds.count(entry.iEventId))
+      continue;
+    events.push_back(entry);
+  }
+
+  events.insert(events.end(), entries.begin(), entries.end());
+  std::stable_sort(events.begin(), events.end(), EntryStartsBefore);
+
+  // the previous generation and the arena of the load are released as a whole
+  m_events.swap(events);
+  Repack();
+  arena.Clear();
+
+  UpdateFingerprint();
+
+  if (m_coverage.empty())
+  {
+    m_iLastUpdate = time(NULL);
+    m_iLastFullUpdate = m_iLastUpdate;
+  }
+
+  AddCoverage(iStart, iEnd);
+
+  // the fetched range comes with descriptions, surviving events without one keep lacking it
+  RemoveRange(m_dropped, iStart, iEnd);
+}
+
+void VuChannelEPG::Repack(void)
+{
+  // one block of the exact size each, most channels only hold a few events
+  size_t iStrings = 0;
+  size_t iPlots = 0;
+  for (unsigned int i = 0; i < m_events.size(); i++)
+  {
+    const VuEPGEntry &entry = m_events[i];
+    iStrings += VuStringArena::GetStoredSize(entry.strTitle.length()) + VuStringArena::GetStoredSize(entry.strPlotOutline.length());
+    iPlots += VuStringArena::GetStoredSize(entry.strPlot.length());
+  }
+
+  VuStringArena strings, plots;
+  strings.Reserve(iStrings);
+  plots.Reserve(iPlots);
+  for (unsigned int i = 0; i < m_events.size(); i++)
+  {
+    VuEPGEntry &entry = m_events[i];
+    entry.strTitle = strings.Add(entry.strTitle.c_str(), entry.strTitle.length());
+    entry.strPlotOutline = strings.Add(entry.strPlotOutline.c_str(), entry.strPlotOutline.length());
+    entry.strPlot = plots.Add(entry.strPlot.c_str(), entry.strPlot.length());
+  }
+
+  m_strings = std::move(strings);
+  m_plots = std::move(plots);
+
+  m_eventSlots.clear();
+  for (unsigned int i = 0; i < m_events.size(); i++)
+    m_eventSlots[m_events[i].iEventId] = i;
+}
+
+void VuChannelEPG::Evict(time_t iFrom, const std::function<bool(const VuEPGEntry &)> &spill)
+{
+  std::vector<VuEPGEntry>::iterator first = std::lower_bound(m_events.begin(), m_events.end(), iFrom, EntryStartsBeforeTime);
+  if (first == m_events.end())
+    return;
+
+  std::vector<VuEPGEntry>::iterator kept = first;
+  for (std::vector<VuEPGEntry>::iterator it = first; it != m_events.end(); it++)
+  {
+    if (!spill(*it))
+      *kept++ = *it;
+  }
+  m_events.erase(kept, m_events.end());
+
+  Repack();
+  UpdateFingerprint();
+}
+
+void VuChannelEPG::Clear(void)
+{
+  // swapped with empty containers, clear() would keep their memory
+  std::vector<VuEPGEntry>().swap(m_events);
+  m_strings.Clear();
+  m_plots.Clear();
+  std::vector<VuTimeRange>().swap(m_dropped);
+  std::unordered_map<int, unsigned int>().swap(m_eventSlots);
+  std::vector<VuTimeRange>().swap(m_coverage);
+  m_iLastUpdate = 0;
+  m_iLastFullUpdate = 0;
+  UpdateFingerprint();
+}
+
+unsigned int VuChannelEPG::HashEvent(const VuEPGEntry &entry)
+{
+  int iTimes[3] = { entry.iEventId, (int)entry.startTime, (int)entry.endTime };
+  unsigned int iHash = HashBytes(2166136261u, iTimes, sizeof(iTimes));
+  iHash = HashBytes(iHash, entry.strTitle.c_str(), entry.strTitle.length() + 1);
+
+  // FNV alone changes by the same amount for a one character change, which
+  // cancels out in a sum, so the bits are mixed once more
+  iHash ^= iHash >> 16;
+  iHash *= 0x85ebca6bu;
+  iHash ^= iHash >> 13;
+  iHash *= 0xc2b2ae35u;
+  iHash ^= iHash >> 16;
+  return iHash;
+}
+
+void VuChannelEPG::UpdateFingerprint(void)
+{
+  unsigned int iSum = 0;
+  for (unsigned int i = 0; i < m_events.size(); i++)
+    iSum += HashEvent(m_events[i]);
+  m_iFingerprint = iSum;
+}
+
+void VuChannelEPG::DropDescriptions(void)
+{
+  if (m_plots.GetSize() == 0)
+    return;
+
+  for (unsigned int i = 0; i < m_events.size(); i++)
+    m_events[i].strPlot = VuStringRef();
+
+  m_plots.Clear();
+
+  if (!m_events.empty())
+    AddRange(m_dropped, m_events.front().startTime, m_events.back().startTime + 1);
+}
+
+bool VuChannelEPG::HasDescriptions(time_t iStart, time_t iEnd) const
+{
+  if (m_dropped.empty())
+    return true;
+
+  unsigned int iFirst, iLast;
+  GetWindow(iStart, iEnd, iFirst, iLast);
+
+  for (unsigned int i = iFirst; i < iLast; i++)
+  {
+    for (unsigned int j = 0; j < m_dropped.size() && m_dropped[j].first <= m_events[i].startTime; j++)
+    {
+      if (m_events[i].startTime < m_dropped[j].second)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+size_t VuChannelEPG::GetMemorySize(void) const
+{
+  return VuVectorBytes(m_events) + m_strings.GetSize() + m_plots.GetSize() +
+         VuHashBytes(m_eventSlots) + VuVectorBytes(m_coverage) + VuVectorBytes(m_dropped);
+}
+
+void VuChannelEPG::AddCoverage(time_t iStart, time_t iEnd)
+{
+  AddRange(m_coverage, iStart, iEnd);
+}
+
+void VuChannelEPG::GetMissingRanges(time_t iStart, time_t iEnd, std::vector<VuTimeRange> &ranges) const
+{
+  ranges.clear();
+
+  for (unsigned int i = 0; i < m_coverage.size() && iStart < iEnd; i++)
+  {
+    const VuTimeRange &covered = m_coverage[i];
+    if (covered.second <= iStart)
+      continue;
+    if (covered.first >= iEnd)
+      break;
+
+    if (covered.first > iStart)
+      ranges.push_back(VuTimeRange(iStart, covered.first));
+
+    iStart = covered.second;
+  }
+
+  if (iStart < iEnd)
+    ranges.push_back(VuTimeRange(iStart, iEnd));
+}
+
+bool VuChannelEPG::IsValid(time_t now) const
+{
+  return m_iLastUpdate != 0 && now - m_iLastUpdate < EPG_MAX_AGE;
+}
+
+void VuChannelEPG::GetWindow(time_t iStart, time_t iEnd, unsigned int &iFirst, unsigned int &iLast) const
+{
+  std::vector<VuEPGEntry>::const_iterator first = std::lower_bound(m_events.begin(), m_events.end(), iStart, EntryStartsBeforeTime);
+
+  // include the event that is already running at the start of the window
+  if (first != m_events.begin() && (first-1)->endTime > iStart)
+    first--;
+
+  std::vector<VuEPGEntry>::const_iterator last = m_events.end();
+  if (iEnd > 1)
+    last = std::lower_bound(first, m_events.end(), iEnd, EntryStartsBeforeTime);
+
+  iFirst = first - m_events.begin();
+  iLast = last - m_events.begin();
+}
+
+const VuEPGEntry *VuChannelEPG::GetEvent(int iEventId) const
+{
+  std::unordered_map<int, unsigned int>::const_iterator it = m_eventSlots.find(iEventId);
+  if (it == m_eventSlots.end())
+    return NULL;
+
+  return &m_events[it->second];
+}
+
+VuChannelLRU::VuChannelLRU(void)
+{
+  m_iSize = 0;
+}
+
+void VuChannelLRU::Reset(unsigned int iChannels)
+{
+  m_order.clear();
+  m_positions.assign(iChannels, m_order.end());
+  m_bytes.assign(iChannels, 0);
+  m_iSize = 0;
+}
+
+void VuChannelLRU::Touch(unsigned int iChannel, size_t iBytes)
+{
+  if (iChannel >= m_positions.size())
+    return;
+
+  Remove(iChannel);
+  m_order.push_front(iChannel);
+  m_positions[iChannel] = m_order.begin();
+  m_bytes[iChannel] = iBytes;
+  m_iSize += iBytes;
+}
+
+void VuChannelLRU::Resize(unsigned int iChannel, size_t iBytes)
+{
+  if (iChannel >= m_positions.size() || m_positions[iChannel] == m_order.end())
+    return;
+
+  m_iSize = m_iSize - m_bytes[iChannel] + iBytes;
+  m_bytes[iChannel] = iBytes;
+}
+
+void VuChannelLRU::Remove(unsigned int iChannel)
+{
+  if (iChannel >= m_positions.size() || m_positions[iChannel] == m_order.end())
+    return;
+
+  m_order.erase(m_positions[iChannel]);
+  m_positions[iChannel] = m_order.end();
+  m_iSize -= m_bytes[iChannel];
+  m_bytes[iChannel] = 0;
+}
+
+bool VuChannelLRU::GetOldest(unsigned int &iChannel) const
+{
+  if (m_order.empty())
+    return false;
+
+  iChannel = m_order.back();
+  return true;
+}
@@ -0,0 +1,150 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <list>
+#include "VuArena.h"
+#include "VuMemory.h"
+
+// length of the window used when Kodi does not pass an end time
+#define EPG_OPEN_WINDOW  (14 * 24 * 60 * 60)
+// seconds after which the update thread refreshes the EPG of a channel
+#define EPG_REFRESH_INTERVAL  (30 * 60)
+// channels this close to the current one are refreshed every EPG_REFRESH_INTERVAL,
+// all others EPG_FAR_REFRESH_FACTOR times less often
+#define EPG_NEAR_CHANNELS  10
+#define EPG_FAR_REFRESH_FACTOR  4
+// seconds a channel EPG is served from memory without a refresh before it is
+// fetched again, twice the longest refresh interval to allow for late refreshes
+#define EPG_MAX_AGE  (2 * EPG_REFRESH_INTERVAL * EPG_FAR_REFRESH_FACTOR)
+// a refresh fetches the next EPG_NEAR_WINDOW seconds plus the uncovered end of the
+// open window, the whole open window only every EPG_FULL_REFRESH_INTERVAL seconds
+#define EPG_NEAR_WINDOW  (6 * 60 * 60)
+#define EPG_FULL_REFRESH_INTERVAL  (12 * 60 * 60)
+// seconds until the update thread retries the refresh of a channel that failed
+#define EPG_RETRY_DELAY  (5 * 60)
+
+// the strings point into the VuStringArena of the load the entry came from,
+// or into the arenas of the VuChannelEPG once merged
+struct VuEPGEntry 
+{
+  int iEventId;
+  unsigned int iServiceRef; // id in the service reference table of the client
+  VuStringRef strTitle;
+  int iChannelId;
+  time_t startTime;
+  time_t endTime;
+  VuStringRef strPlotOutline;
+  VuStringRef strPlot;
+};
+
+typedef std::pair<time_t, time_t> VuTimeRange; // [first, second)
+
+/*
+ * The EPG of one channel, sorted by start time. Window queries are
+ * answered with a binary search, events can be looked up by their id.
+ * The time ranges already fetched from the backend are tracked, so
+ * that only the uncovered parts of a window have to be requested.
+ */
+class VuChannelEPG
+{
+public:
+  VuChannelEPG(void);
+
+  // copies the strings of entries out of arena, which is released
+  void Merge(std::vector<VuEPGEntry> &entries, VuStringArena &arena, time_t iStart, time_t iEnd);
+  void Clear(void);
+  // hands the events starting at or after iFrom to spill and forgets them,
+  // those spill returns false for are kept. Coverage stays.
+  void Evict(time_t iFrom, const std::function<bool(const VuEPGEntry &)> &spill);
+  // releases the long descriptions, the events lack them until they are fetched again
+  void DropDescriptions(void);
+  // false if an event running in [iStart, iEnd) lost its description
+  bool HasDescriptions(time_t iStart, time_t iEnd) const;
+  size_t GetDescriptionSize(void) const { return m_plots.GetSize(); }
+  size_t GetMemorySize(void) const;
+  void GetMissingRanges(time_t iStart, time_t iEnd, std::vector<VuTimeRange> &ranges) const;
+
+  bool IsEmpty(void) const { return m_events.empty(); }
+  bool IsValid(time_t now) const;
+  time_t GetLastUpdate(void) const { return m_iLastUpdate; }
+  void SetLastUpdate(time_t iLastUpdate) { m_iLastUpdate = iLastUpdate; }
+  // when the whole open window was fetched last
+  time_t GetLastFullUpdate(void) const { return m_iLastFullUpdate; }
+  void SetLastFullUpdate(time_t iLastFullUpdate) { m_iLastFullUpdate = iLastFullUpdate; }
+  unsigned int GetFingerprint(void) const { return m_iFingerprint; }
+  // the fingerprint is the sum of the hashes of all events, so that it does
+  // not depend on their order or on which tier of the EPG holds them
+  static unsigned int HashEvent(const VuEPGEntry &entry);
+
+  void GetWindow(time_t iStart, time_t iEnd, unsigned int &iFirst, unsigned int &iLast) const;
+  const VuEPGEntry &At(unsigned int iSlot) const { return m_events[iSlot]; }
+  const VuEPGEntry *GetEvent(int iEventId) const;
+
+private:
+  std::vector<VuEPGEntry> m_events;
+  VuStringArena m_strings; // titles and outlines of m_events, replaced with every merge
+  VuStringArena m_plots; // strPlot of m_events, kept apart so they can be dropped on their own
+  std::vector<VuTimeRange> m_dropped; // start times of events that lost their strPlot to DropDescriptions, sorted, non-overlapping
+  std::unordered_map<int, unsigned int> m_eventSlots; // event id -> m_events index
+  std::vector<VuTimeRange> m_coverage; // sorted, non-overlapping
+  time_t m_iLastUpdate;
+  time_t m_iLastFullUpdate;
+  unsigned int m_iFingerprint; // sum of HashEvent over m_events
+
+  void AddCoverage(time_t iStart, time_t iEnd);
+  void UpdateFingerprint(void);
+  // copies the strings of m_events into fresh arenas and rebuilds m_eventSlots
+  void Repack(void);
+};
+
+/*
+ * Least recently used order of channels, along with the bytes of EPG
+ * data each of them keeps. The oldest ones are dropped once all of them
+ * together exceed a budget.
+ */
+class VuChannelLRU
+{
+public:
+  VuChannelLRU(void);
+
+  // forgets all channels
+  void Reset(unsigned int iChannels);
+  void Touch(unsigned int iChannel, size_t iBytes);
+  // updates the bytes of a listed channel without making it more recent
+  void Resize(unsigned int iChannel, size_t iBytes);
+  void Remove(unsigned int iChannel);
+  bool GetOldest(unsigned int &iChannel) const;
+  size_t GetSize(void) const { return m_iSize; }
+
+private:
+  std::list<unsigned int> m_order; // most recently used first
+  std::vector<std::list<unsigned int>::iterator> m_positions; // m_order.end() if the channel is not listed
+  std::vector<size_t> m_bytes;
+  size_t m_iSize;
+};
@@ -0,0 +1,482 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+
+#include "VuEPGStore.h"
+#include "client.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+using namespace ADDON;
+
+// layout of a record in the segment, followed by title, outline and plot
+struct VuColdRecordHeader
+{
+  int64_t startTime;
+  int64_t endTime;
+  int32_t iEventId;
+  int32_t iChannelId;
+  uint32_t iServiceRef;
+  uint32_t iTitleLength;
+  uint32_t iOutlineLength;
+  uint32_t iPlotLength;
+};
+
+// 32 bit FNV-1a
+static unsigned int HashRecord(const std::vector<char> &record)
+{
+  unsigned int iHash = 2166136261u;
+  for (size_t i = 0; i < record.size(); i++)
+  {
+    iHash ^= (unsigned char)record[i];
+    iHash *= 16777619u;
+  }
+  return iHash;
+}
+
+VuEPGColdStore::VuEPGColdStore(void)
+{
+  m_iSegment = 0;
+  m_iNextSegment = 0;
+  m_writeHandle = NULL;
+  m_iFileSize = 0;
+  m_iLiveSize = 0;
+}
+
+VuEPGColdStore::~VuEPGColdStore(void)
+{
+  Close();
+}
+
+std::string VuEPGColdStore::GetSegmentPath(unsigned int iSegment) const
+{
+  char strName[32];
+  snprintf(strName, sizeof(strName), "epgcold%u.seg", iSegment);
+  return m_strDirectory + strName;
+}
+
+bool VuEPGColdStore::Open(const std::string &strDirectory, unsigned int iChannels)
+{
+  Close();
+
+  m_strDirectory = strDirectory;
+  m_iSegment = m_iNextSegment++;
+  m_writeHandle = XBMC->OpenFileForWrite(GetSegmentPath(m_iSegment).c_str(), true);
+  if (!m_writeHandle)
+  {
+    XBMC->Log(LOG_ERROR, "%s Could not create the EPG segment '%s'", __FUNCTION__, GetSegmentPath(m_iSegment).c_str());
+    return false;
+  }
+
+  m_channels.assign(iChannels, std::vector<ColdEvent>());
+  m_fingerprints.assign(iChannels, 0);
+  return true;
+}
+
+void VuEPGColdStore::Close(void)
+{
+  if (!m_writeHandle)
+    return;
+
+  XBMC->CloseFile(m_writeHandle);
+  m_writeHandle = NULL;
+  XBMC->DeleteFile(GetSegmentPath(m_iSegment).c_str());
+
+  m_channels.clear();
+  m_fingerprints.clear();
+  m_iFileSize = 0;
+  m_iLiveSize = 0;
+}
+
+void VuEPGColdStore::Serialize(const VuEPGEntry &entry, std::vector<char> &record)
+{
+  VuColdRecordHeader header;
+  header.startTime = entry.startTime;
+  header.endTime = entry.endTime;
+  header.iEventId = entry.iEventId;
+  header.iChannelId = entry.iChannelId;
+  header.iServiceRef = entry.iServiceRef;
+  header.iTitleLength = entry.strTitle.length();
+  header.iOutlineLength = entry.strPlotOutline.length();
+  header.iPlotLength = entry.strPlot.length();
+
+  record.resize(sizeof(header) + header.iTitleLength + header.iOutlineLength + header.iPlotLength);
+  char *p = &record[0];
+  memcpy(p, &header, sizeof(header));
+  p += sizeof(header);
+  memcpy(p, entry.strTitle.c_str(), header.iTitleLength);
+  p += header.iTitleLength;
+  memcpy(p, entry.strPlotOutline.c_str(), header.iOutlineLength);
+  p += header.iOutlineLength;
+  memcpy(p, entry.strPlot.c_str(), header.iPlotLength);
+}
+
+void VuEPGColdStore::BeginUpdate(unsigned int iChannel, time_t iStart, time_t iEnd)
+{
+  if (iChannel >= m_channels.size())
+    return;
+
+  std::vector<ColdEvent> &events = m_channels[iChannel];
+  for (unsigned int i = 0; i < events.size() && events[i].startTime < iEnd; i++)
+  {
+    if (events[i].startTime >= iStart)
+      events[i].bStale = true;
+  }
+}
+
+bool VuEPGColdStore::Store(unsigned int iChannel, const VuEPGEntry &entry)
+{
+  if (!m_writeHandle || iChannel >= m_channels.size())
+    return false;
+
+  std::vector<char> record;
+  Serialize(entry, record);
+  unsigned int iContentHash = HashRecord(record);
+
+  // the same record is kept as it is
+  std::vector<ColdEvent> &events = m_channels[iChannel];
+  std::vector<ColdEvent>::iterator it = events.begin();
+  while (it != events.end() && it->startTime < entry.startTime)
+    it++;
+  for (; it != events.end() && it->startTime == entry.startTime; it++)
+  {
+    if (it->iEventId == entry.iEventId && it->iContentHash == iContentHash && it->iSize == record.size())
+    {
+      it->bStale = false;
+      return true;
+    }
+  }
+
+  // an older version of the event is superseded
+  for (it = events.begin(); it != events.end(); it++)
+  {
+    if (it->iEventId == entry.iEventId)
+    {
+      Remove(iChannel, it, it + 1);
+      break;
+    }
+  }
+
+  if (XBMC->WriteFile(m_writeHandle, &record[0], record.size()) != (ssize_t)record.size())
+  {
+    XBMC->Log(LOG_ERROR, "%s Could not write to the EPG segment", __FUNCTION__);
+    return false;
+  }
+
+  ColdEvent event;
+  event.startTime = entry.startTime;
+  event.iEventId = entry.iEventId;
+  event.iFingerprint = VuChannelEPG::HashEvent(entry);
+  event.iContentHash = iContentHash;
+  event.iSize = record.size();
+  event.bStale = false;
+  event.iOffset = m_iFileSize;
+
+  it = events.end();
+  while (it != events.begin() && (it-1)->startTime > event.startTime)
+    it--;
+  events.insert(it, event);
+
+  m_iFileSize += record.size();
+  m_iLiveSize += record.size();
+  m_fingerprints[iChannel] += event.iFingerprint;
+  return true;
+}
+
+void VuEPGColdStore::EndUpdate(unsigned int iChannel)
+{
+  if (iChannel >= m_channels.size())
+    return;
+
+  std::vector<ColdEvent> &events = m_channels[iChannel];
+  std::vector<ColdEvent>::iterator kept = events.begin();
+  for (std::vector<ColdEvent>::iterator it = events.begin(); it != events.end(); it++)
+  {
+    if (it->bStale)
+    {
+      m_iLiveSize -= it->iSize;
+      m_fingerprints[iChannel] -= it->iFingerprint;
+    }
+    else
+      *kept++ = *it;
+  }
+  events.erase(kept, events.end());
+}
+
+void VuEPGColdStore::Remove(unsigned int iChannel, std::vector<ColdEvent>::iterator first, std::vector<ColdEvent>::iterator last)
+{
+  for (std::vector<ColdEvent>::iterator it = first; it != last; it++)
+  {
+    m_iLiveSize -= it->iSize;
+    m_fingerprints[iChannel] -= it->iFingerprint;
+  }
+  m_channels[iChannel].erase(first, last);
+}
+
+void VuEPGColdStore::Discard(unsigned int iChannel, time_t iStart, time_t iEnd)
+{
+  if (iChannel >= m_channels.size())
+    return;
+
+  std::vector<ColdEvent> &events = m_channels[iChannel];
+  std::vector<ColdEvent>::iterator first = events.begin();
+  while (first != events.end() && first->startTime < iStart)
+    first++;
+  std::vector<ColdEvent>::iterator last = first;
+  while (last != events.end() && last->startTime < iEnd)
+    last++;
+
+  Remove(iChannel, first, last);
+}
+
+void VuEPGColdStore::Discard(unsigned int iChannel)
+{
+  if (iChannel >= m_channels.size())
+    return;
+
+  Remove(iChannel, m_channels[iChannel].begin(), m_channels[iChannel].end());
+}
+
+unsigned int VuEPGColdStore::GetFingerprint(unsigned int iChannel) const
+{
+  return iChannel < m_fingerprints.size() ? m_fingerprints[iChannel] : 0;
+}
+
+bool VuEPGColdStore::ReadRecord(void *readHandle, const ColdEvent &event, std::vector<char> &buffer, VuEPGEntry &entry, VuStringArena &arena)
+{
+  buffer.resize(event.iSize);
+  if (XBMC->SeekFile(readHandle, event.iOffset, SEEK_SET) != event.iOffset ||
+      XBMC->ReadFile(readHandle, &buffer[0], event.iSize) != (ssize_t)event.iSize)
+    return false;
+
+  VuColdRecordHeader header;
+  memcpy(&header, &buffer[0], sizeof(header));
+  if (sizeof(header) + header.iTitleLength + header.iOutlineLength + header.iPlotLength != event.iSize)
+    return false;
+
+  const char *p = &buffer[sizeof(header)];
+  entry.startTime = header.startTime;
+  entry.endTime = header.endTime;
+  entry.iEventId = header.iEventId;
+  entry.iChannelId = header.iChannelId;
+  entry.iServiceRef = header.iServiceRef;
+  entry.strTitle = arena.Add(p, header.iTitleLength);
+  p += header.iTitleLength;
+  entry.strPlotOutline = arena.Add(p, header.iOutlineLength);
+  p += header.iOutlineLength;
+  entry.strPlot = arena.Add(p, header.iPlotLength);
+  return true;
+}
+
+bool VuEPGColdStore::Read(unsigned int iChannel, time_t iStart, time_t iEnd, std::vector<VuEPGEntry> &entries, VuStringArena &arena)
+{
+  if (!m_writeHandle || iChannel >= m_channels.size())
+    return false;
+
+  const std::vector<ColdEvent> &events = m_channels[iChannel];
+  unsigned int i = 0;
+  while (i < events.size() && events[i].startTime < iStart)
+    i++;
+  if (i == events.size() || events[i].startTime >= iEnd)
+    return true;
+
+  void *readHandle = XBMC->OpenFile(GetSegmentPath(m_iSegment).c_str(), 0);
+  if (!readHandle)
+  {
+    XBMC->Log(LOG_ERROR, "%s Could not open the EPG segment", __FUNCTION__);
+    return false;
+  }
+
+  bool bOk = true;
+  std::vector<char> buffer;
+  for (; i < events.size() && events[i].startTime < iEnd; i++)
+  {
+    VuEPGEntry entry;
+    if (!ReadRecord(readHandle, events[i], buffer, entry, arena))
+    {
+      XBMC->Log(LOG_ERROR, "%s Could not read event '%d' from the EPG segment", __FUNCTION__, events[i].iEventId);
+      bOk = false;
+      break;
+    }
+    entries.push_back(entry);
+  }
+
+  XBMC->CloseFile(readHandle);
+  return bOk;
+}
+
+bool VuEPGColdStore::ReadEvent(unsigned int iChannel, int iEventId, VuEPGEntry &entry, VuStringArena &arena)
+{
+  if (!m_writeHandle || iChannel >= m_channels.size())
+    return false;
+
+  const std::vector<ColdEvent> &events = m_channels[iChannel];
+  for (unsigned int i = 0; i < events.size(); i++)
+  {
+    if (events[i].iEventId != iEventId)
+      continue;
+
+    void *readHandle = XBMC->OpenFile(GetSegmentPath(m_iSegment).c_str(), 0);
+    if (!readHandle)
+      return false;
+
+    std::vector<char> buffer;
+    bool bOk = ReadRecord(readHandle, events[i], buffer, entry, arena);
+    XBMC->CloseFile(readHandle);
+    return bOk;
+  }
+
+  return false;
+}
+
+size_t VuEPGColdStore::GetIndexSize(void) const
+{
+  size_t iSize = m_channels.capacity() * sizeof(std::vector<ColdEvent>) + m_fingerprints.capacity() * sizeof(unsigned int);
+  for (unsigned int i = 0; i < m_channels.size(); i++)
+    iSize += m_channels[i].capacity() * sizeof(ColdEvent);
+  return iSize;
+}
+
+bool VuEPGColdStore::PrepareCompaction(Compaction &compaction)
+{
+  if (!m_writeHandle || m_iFileSize <= EPG_COLD_COMPACT_MIN || m_iFileSize <= m_iLiveSize * EPG_COLD_COMPACT_FACTOR)
+    return false;
+
+  compaction.iSource = m_iSegment;
+  compaction.strSource = GetSegmentPath(m_iSegment);
+  compaction.iTarget = m_iNextSegment++;
+  compaction.strTarget = GetSegmentPath(compaction.iTarget);
+  compaction.iSourceSize = m_iFileSize;
+  compaction.records.clear();
+  compaction.offsets.clear();
+  compaction.targetHandle = NULL;
+  compaction.iTargetSize = 0;
+  compaction.bOk = false;
+
+  for (unsigned int i = 0; i < m_channels.size(); i++)
+  {
+    for (unsigned int j = 0; j < m_channels[i].size(); j++)
+      compaction.records.push_back(std::make_pair(m_channels[i][j].iOffset, m_channels[i][j].iSize));
+  }
+
+  // copied in file order
+  std::sort(compaction.records.begin(), compaction.records.end());
+  return true;
+}
+
+bool VuEPGColdStore::CopyRecord(void *readHandle, void *writeHandle, int64_t iOffset, uint32_t iSize, std::vector<char> &buffer)
+{
+  buffer.resize(iSize);
+  return XBMC->SeekFile(readHandle, iOffset, SEEK_SET) == iOffset &&
+         XBMC->ReadFile(readHandle, &buffer[0], iSize) == (ssize_t)iSize &&
+         XBMC->WriteFile(writeHandle, &buffer[0], iSize) == (ssize_t)iSize;
+}
+
+void VuEPGColdStore::CopyRecords(Compaction &compaction)
+{
+  // the source is only appended to meanwhile, the records up to iSourceSize stay as they are
+  void *readHandle = XBMC->OpenFile(compaction.strSource.c_str(), 0);
+  compaction.targetHandle = XBMC->OpenFileForWrite(compaction.strTarget.c_str(), true);
+  compaction.bOk = readHandle != NULL && compaction.targetHandle != NULL;
+
+  std::vector<char> buffer;
+  for (unsigned int i = 0; i < compaction.records.size() && compaction.bOk; i++)
+  {
+    int64_t iOffset = compaction.records[i].first;
+    uint32_t iSize = compaction.records[i].second;
+    compaction.bOk = CopyRecord(readHandle, compaction.targetHandle, iOffset, iSize, buffer);
+    compaction.offsets[iOffset] = compaction.iTargetSize;
+    compaction.iTargetSize += iSize;
+  }
+
+  if (readHandle)
+    XBMC->CloseFile(readHandle);
+}
+
+void VuEPGColdStore::FinishCompaction(Compaction &compaction)
+{
+  bool bOk = compaction.bOk && m_writeHandle && compaction.iSource == m_iSegment;
+
+  // records appended during the copy are copied now
+  void *readHandle = bOk ? XBMC->OpenFile(compaction.strSource.c_str(), 0) : NULL;
+  bOk = bOk && readHandle != NULL;
+
+  std::vector<char> buffer;
+  for (unsigned int i = 0; i < m_channels.size() && bOk; i++)
+  {
+    for (unsigned int j = 0; j < m_channels[i].size() && bOk; j++)
+    {
+      const ColdEvent &event = m_channels[i][j];
+      if (event.iOffset < compaction.iSourceSize)
+      {
+        bOk = compaction.offsets.count(event.iOffset) != 0;
+        continue;
+      }
+
+      bOk = CopyRecord(readHandle, compaction.targetHandle, event.iOffset, event.iSize, buffer);
+      compaction.offsets[event.iOffset] = compaction.iTargetSize;
+      compaction.iTargetSize += event.iSize;
+    }
+  }
+
+  if (readHandle)
+    XBMC->CloseFile(readHandle);
+
+  if (!bOk)
+  {
+    // carry on with the old segment, it is still intact
+    if (compaction.bOk)
+      XBMC->Log(LOG_DEBUG, "%s Dropped the compaction of an EPG segment that changed", __FUNCTION__);
+    else
+      XBMC->Log(LOG_ERROR, "%s Could not compact the EPG segment", __FUNCTION__);
+
+    if (compaction.targetHandle)
+      XBMC->CloseFile(compaction.targetHandle);
+    compaction.targetHandle = NULL;
+    XBMC->DeleteFile(compaction.strTarget.c_str());
+    return;
+  }
+
+  int64_t iLiveSize = 0;
+  for (unsigned int i = 0; i < m_channels.size(); i++)
+  {
+    for (unsigned int j = 0; j < m_channels[i].size(); j++)
+    {
+      ColdEvent &event = m_channels[i][j];
+      event.iOffset = compaction.offsets[event.iOffset];
+      iLiveSize += event.iSize;
+    }
+  }
+
+  XBMC->Log(LOG_DEBUG, "%s Compacted the EPG segment from %lld to %lld bytes", __FUNCTION__, (long long)m_iFileSize, (long long)compaction.iTargetSize);
+
+  XBMC->CloseFile(m_writeHandle);
+  XBMC->DeleteFile(compaction.strSource.c_str());
+
+  m_writeHandle = compaction.targetHandle;
+  compaction.targetHandle = NULL;
+  m_iSegment = compaction.iTarget;
+  m_iFileSize = compaction.iTargetSize;
+  m_iLiveSize = iLiveSize;
+}
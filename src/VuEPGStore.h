@@ -0,0 +1,129 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "VuEPG.h"
+
+// the cold segment is rewritten once less than 1/EPG_COLD_COMPACT_FACTOR of it is live
+#define EPG_COLD_COMPACT_FACTOR  2
+// segments smaller than this are never rewritten
+#define EPG_COLD_COMPACT_MIN  (4 * 1024 * 1024)
+// seconds between moves of cold events into the advancing hot window
+#define EPG_PROMOTE_INTERVAL  (15 * 60)
+
+/*
+ * The cold tier of the EPG: events starting beyond the hot window are
+ * appended to a segment file in the addon data folder, only their start
+ * time, id, hashes and file offset stay in memory. Events stored again
+ * unchanged keep their record, superseded ones are dropped from the index
+ * and left in the file until the segment is compacted into a new file.
+ * The segment is private to one session and starts empty, the backend
+ * remains the source of truth.
+ * Not thread safe, the caller guards it along with the hot tier. Only the
+ * copying step of a compaction runs without that guard.
+ */
+class VuEPGColdStore
+{
+public:
+  // a compaction in progress, see PrepareCompaction
+  struct Compaction
+  {
+    unsigned int iSource; // segment numbers
+    unsigned int iTarget;
+    std::string strSource;
+    std::string strTarget;
+    int64_t iSourceSize; // records past it were appended during the copy
+    std::vector<std::pair<int64_t, uint32_t> > records; // offset and size of the live records
+    std::unordered_map<int64_t, int64_t> offsets; // source -> target offset of the copied records
+    void *targetHandle;
+    int64_t iTargetSize;
+    bool bOk;
+  };
+
+  VuEPGColdStore(void);
+  ~VuEPGColdStore(void);
+
+  // starts with an empty segment in strDirectory
+  bool Open(const std::string &strDirectory, unsigned int iChannels);
+  void Close(void);
+  bool IsOpen(void) const { return m_writeHandle != NULL; }
+
+  // Replaces the events of a channel starting in [iStart, iEnd): the ones
+  // passed to Store in between are kept, all others are forgotten by EndUpdate.
+  void BeginUpdate(unsigned int iChannel, time_t iStart, time_t iEnd);
+  // appends the event unless the same record is stored already
+  bool Store(unsigned int iChannel, const VuEPGEntry &entry);
+  void EndUpdate(unsigned int iChannel);
+  // forgets the events of a channel starting in [iStart, iEnd)
+  void Discard(unsigned int iChannel, time_t iStart, time_t iEnd);
+  void Discard(unsigned int iChannel);
+  // reads the events of a channel starting in [iStart, iEnd) in start order,
+  // with their strings copied to arena
+  bool Read(unsigned int iChannel, time_t iStart, time_t iEnd, std::vector<VuEPGEntry> &entries, VuStringArena &arena);
+  bool ReadEvent(unsigned int iChannel, int iEventId, VuEPGEntry &entry, VuStringArena &arena);
+  // sum of VuChannelEPG::HashEvent over the events of a channel
+  unsigned int GetFingerprint(unsigned int iChannel) const;
+
+  // Compacting takes three steps, the caller's guard is released during the
+  // second one. Prepare returns false if the segment is fine as it is.
+  bool PrepareCompaction(Compaction &compaction);
+  static void CopyRecords(Compaction &compaction);
+  void FinishCompaction(Compaction &compaction);
+
+  size_t GetIndexSize(void) const;
+  int64_t GetLiveSize(void) const { return m_iLiveSize; }
+
+private:
+  struct ColdEvent
+  {
+    time_t startTime;
+    int iEventId;
+    unsigned int iFingerprint; // VuChannelEPG::HashEvent
+    unsigned int iContentHash; // over the whole record
+    uint32_t iSize; // of the record, header included
+    bool bStale; // between BeginUpdate and EndUpdate, not stored again yet
+    int64_t iOffset;
+  };
+
+  std::string m_strDirectory;
+  unsigned int m_iSegment; // number of the segment file written to
+  unsigned int m_iNextSegment; // every segment file of the session gets a new number
+  void *m_writeHandle;
+  int64_t m_iFileSize;
+  int64_t m_iLiveSize; // bytes of the records still indexed
+  std::vector<std::vector<ColdEvent> > m_channels; // sorted by start time
+  std::vector<unsigned int> m_fingerprints;
+
+  std::string GetSegmentPath(unsigned int iSegment) const;
+  bool ReadRecord(void *readHandle, const ColdEvent &event, std::vector<char> &buffer, VuEPGEntry &entry, VuStringArena &arena);
+  void Remove(unsigned int iChannel, std::vector<ColdEvent>::iterator first, std::vector<ColdEvent>::iterator last);
+  static void Serialize(const VuEPGEntry &entry, std::vector<char> &record);
+  static bool CopyRecord(void *readHandle, void *writeHandle, int64_t iOffset, uint32_t iSize, std::vector<char> &buffer);
+
+  VuEPGColdStore(const VuEPGColdStore &);
+  VuEPGColdStore &operator=(const VuEPGColdStore &);
+};
@@ -0,0 +1,384 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuJSON.h"
+#include <cstdlib>
+#include <cstring>
+
+// nesting depth we accept, the OpenWebif responses need 3
+#define JSON_MAX_DEPTH  32
+
+bool VuJSONDocument::Parse(std::string &strJSON)
+{
+  m_values.clear();
+  if (strJSON.empty())
+    return false;
+
+  // a rough guess that avoids most reallocations
+  m_values.reserve(strJSON.length() / 16 + 1);
+
+  m_pos = &strJSON[0];
+  m_end = m_pos + strJSON.length();
+
+  if (!ParseValue())
+  {
+    m_values.clear();
+    return false;
+  }
+
+  SkipWhitespace();
+  return true;
+}
+
+void VuJSONDocument::SkipWhitespace(void)
+{
+  while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r'))
+    m_pos++;
+}
+
+unsigned int VuJSONDocument::AddValue(VU_JSON_TYPE type)
+{
+  VuJSONValue value;
+  value.type = type;
+  value.str = NULL;
+  value.number = 0;
+  value.iNext = m_values.size() + 1;
+  value.iChildren = 0;
+  m_values.push_back(value);
+  return m_values.size() - 1;
+}
+
+static char *EncodeUTF8(char *out, unsigned int iCodepoint)
+{
+  if (iCodepoint < 0x80)
+    *out++ = (char)iCodepoint;
+  else if (iCodepoint < 0x800)
+  {
+    *out++ = (char)(0xC0 | (iCodepoint >> 6));
+    *out++ = (char)(0x80 | (iCodepoint & 0x3F));
+  }
+  else if (iCodepoint < 0x10000)
+  {
+    *out++ = (char)(0xE0 | (iCodepoint >> 12));
+    *out++ = (char)(0x80 | ((iCodepoint >> 6) & 0x3F));
+    *out++ = (char)(0x80 | (iCodepoint & 0x3F));
+  }
+  else
+  {
+    *out++ = (char)(0xF0 | (iCodepoint >> 18));
+    *out++ = (char)(0x80 | ((iCodepoint >> 12) & 0x3F));
+    *out++ = (char)(0x80 | ((iCodepoint >> 6) & 0x3F));
+    *out++ = (char)(0x80 | (iCodepoint & 0x3F));
+  }
+  return out;
+}
+
+static bool ParseHex4(const char *p, unsigned int &iValue)
+{
+  iValue = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    char c = p[i];
+    iValue <<= 4;
+    if (c >= '0' && c <= '9')
+      iValue |= c - '0';
+    else if (c >= 'a' && c <= 'f')
+      iValue |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      iValue |= c - 'A' + 10;
+    else
+      return false;
+  }
+  return true;
+}
+
+bool VuJSONDocument::ParseString(const char *&str)
+{
+  // m_pos is on the opening quote, the unescaped string is written over the input
+  char *in = ++m_pos;
+  char *out = in;
+  str = out;
+
+  while (in < m_end && *in != '"')
+  {
+    if (*in != '\\')
+    {
+      *out++ = *in++;
+      continue;
+    }
+
+    if (++in >= m_end)
+      return false;
+
+    switch (*in++)
+    {
+      case '"':  *out++ = '"';  break;
+      case '\\': *out++ = '\\'; break;
+      case '/':  *out++ = '/';  break;
+      case 'b':  *out++ = '\b'; break;
+      case 'f':  *out++ = '\f'; break;
+      case 'n':  *out++ = '\n'; break;
+      case 'r':  *out++ = '\r'; break;
+      case 't':  *out++ = '\t'; break;
+      case 'u':
+      {
+        unsigned int iCodepoint;
+        if (in + 4 > m_end || !ParseHex4(in, iCodepoint))
+          return false;
+        in += 4;
+
+        // surrogate pair
+        if (iCodepoint >= 0xD800 && iCodepoint < 0xDC00 && in + 6 <= m_end && in[0] == '\\' && in[1] == 'u')
+        {
+          unsigned int iLow;
+          if (ParseHex4(in + 2, iLow) && iLow >= 0xDC00 && iLow < 0xE000)
+          {
+            iCodepoint = 0x10000 + ((iCodepoint - 0xD800) << 10) + (iLow - 0xDC00);
+            in += 6;
+          }
+        }
+        out = EncodeUTF8(out, iCodepoint);
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+
+  if (in >= m_end)
+    return false;
+
+  // the output never outgrows the input, so there is room for the terminator
+  *out = '\0';
+  m_pos = in + 1;
+  return true;
+}
+
+bool VuJSONDocument::ParseLiteral(const char *strLiteral, VU_JSON_TYPE type, double value)
+{
+  size_t iLength = strlen(strLiteral);
+  if ((size_t)(m_end - m_pos) < iLength || strncmp(m_pos, strLiteral, iLength) != 0)
+    return false;
+
+  m_pos += iLength;
+  unsigned int iValue = AddValue(type);
+  m_values[iValue].number = value;
+  return true;
+}
+
+bool VuJSONDocument::ParseValue(void)
+{
+  struct Container
+  {
+    unsigned int iValue;
+    bool bObject;
+  };
+  Container stack[JSON_MAX_DEPTH];
+  int iDepth = 0;
+
+  while (true)
+  {
+    SkipWhitespace();
+    if (m_pos >= m_end)
+      return false;
+
+    // an object member starts with its key
+    if (iDepth > 0 && stack[iDepth-1].bObject)
+    {
+      if (*m_pos != '"')
+        return false;
+
+      unsigned int iKey = AddValue(VU_JSON_STRING);
+      const char *strKey;
+      if (!ParseString(strKey))
+        return false;
+      m_values[iKey].str = strKey;
+
+      SkipWhitespace();
+      if (m_pos >= m_end || *m_pos != ':')
+        return false;
+      m_pos++;
+      SkipWhitespace();
+      if (m_pos >= m_end)
+        return false;
+    }
+
+    bool bComplete = true;
+    char c = *m_pos;
+
+    if (c == '{' || c == '[')
+    {
+      if (iDepth == JSON_MAX_DEPTH)
+        return false;
+
+      unsigned int iValue = AddValue(c == '{' ? VU_JSON_OBJECT : VU_JSON_ARRAY);
+      m_pos++;
+      SkipWhitespace();
+
+      if (m_pos < m_end && *m_pos == (c == '{' ? '}' : ']'))
+        m_pos++; // empty container
+      else
+      {
+        stack[iDepth].iValue = iValue;
+        stack[iDepth].bObject = (c == '{');
+        iDepth++;
+        bComplete = false;
+      }
+    }
+    else if (c == '"')
+    {
+      unsigned int iValue = AddValue(VU_JSON_STRING);
+      const char *str;
+      if (!ParseString(str))
+        return false;
+      m_values[iValue].str = str;
+    }
+    else if (c == 't')
+    {
+      if (!ParseLiteral("true", VU_JSON_BOOL, 1))
+        return false;
+    }
+    else if (c == 'f')
+    {
+      if (!ParseLiteral("false", VU_JSON_BOOL, 0))
+        return false;
+    }
+    else if (c == 'n')
+    {
+      if (!ParseLiteral("null", VU_JSON_NULL, 0))
+        return false;
+    }
+    else
+    {
+      char *pEnd;
+      double number = strtod(m_pos, &pEnd);
+      if (pEnd == m_pos || pEnd > m_end)
+        return false;
+      m_pos = pEnd;
+      unsigned int iValue = AddValue(VU_JSON_NUMBER);
+      m_values[iValue].number = number;
+    }
+
+    // close all containers that end after this value
+    while (bComplete && iDepth > 0)
+    {
+      Container &parent = stack[iDepth-1];
+      m_values[parent.iValue].iChildren++;
+
+      SkipWhitespace();
+      if (m_pos >= m_end)
+        return false;
+
+      if (*m_pos == ',')
+      {
+        m_pos++;
+        bComplete = false;
+      }
+      else if (*m_pos == (parent.bObject ? '}' : ']'))
+      {
+        m_pos++;
+        m_values[parent.iValue].iNext = m_values.size();
+        iDepth--;
+      }
+      else
+        return false;
+    }
+
+    if (iDepth == 0)
+      return true;
+  }
+}
+
+const VuJSONValue *VuJSONDocument::FirstChild(const VuJSONValue *parent) const
+{
+  if (!parent || parent->iChildren == 0)
+    return NULL;
+
+  const VuJSONValue *child = parent + 1;
+  if (parent->type == VU_JSON_OBJECT)
+    child++; // skip the key
+
+  return child;
+}
+
+const VuJSONValue *VuJSONDocument::NextSibling(const VuJSONValue *parent, const VuJSONValue *child) const
+{
+  unsigned int iNext = child->iNext;
+  if (iNext >= parent->iNext)
+    return NULL;
+
+  if (parent->type == VU_JSON_OBJECT)
+    iNext++; // skip the key
+
+  return &m_values[iNext];
+}
+
+const VuJSONValue *VuJSONDocument::Get(const VuJSONValue *object, const char *strKey) const
+{
+  if (!object || object->type != VU_JSON_OBJECT)
+    return NULL;
+
+  for (const VuJSONValue *value = FirstChild(object); value; value = NextSibling(object, value))
+  {
+    const VuJSONValue *key = value - 1;
+    if (strcmp(key->str, strKey) == 0)
+      return value;
+  }
+  return NULL;
+}
+
+bool VuJSONDocument::GetString(const VuJSONValue *object, const char *strKey, std::string &strValue) const
+{
+  const VuJSONValue *value = Get(object, strKey);
+  if (!value || value->type != VU_JSON_STRING)
+    return false;
+
+  strValue = value->str;
+  return true;
+}
+
+bool VuJSONDocument::GetInt(const VuJSONValue *object, const char *strKey, int &iValue) const
+{
+  const VuJSONValue *value = Get(object, strKey);
+  if (!value)
+    return false;
+
+  if (value->type == VU_JSON_NUMBER || value->type == VU_JSON_BOOL)
+    iValue = (int)value->number;
+  else if (value->type == VU_JSON_STRING && value->str[0] != '\0')
+    iValue = atoi(value->str);
+  else
+    return false;
+
+  return true;
+}
+
+bool VuJSONDocument::GetBoolean(const VuJSONValue *object, const char *strKey, bool &bValue) const
+{
+  int iValue;
+  if (!GetInt(object, strKey, iValue))
+    return false;
+
+  bValue = iValue != 0;
+  return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+
+typedef enum VU_JSON_TYPE
+{
+  VU_JSON_NULL,
+  VU_JSON_BOOL,
+  VU_JSON_NUMBER,
+  VU_JSON_STRING,
+  VU_JSON_ARRAY,
+  VU_JSON_OBJECT
+} VU_JSON_TYPE;
+
+struct VuJSONValue
+{
+  VU_JSON_TYPE type;
+  const char *str;        // string values and object keys, NUL terminated inside the parsed buffer
+  double number;          // numbers and booleans
+  unsigned int iNext;     // index of the value following this one and all its children
+  unsigned int iChildren; // array elements or object members
+};
+
+/*
+ * A small in-situ JSON parser for the responses of the OpenWebif api. Strings
+ * are unescaped and terminated inside the buffer passed to Parse(), so
+ * that buffer has to outlive the document. Values are stored in one flat
+ * array in document order. An object member is a string value holding
+ * the key, directly followed by its value.
+ */
+class VuJSONDocument
+{
+public:
+  bool Parse(std::string &strJSON);
+
+  const VuJSONValue *Root(void) const { return m_values.empty() ? NULL : &m_values[0]; }
+
+  // iterate over the elements of an array or the values of an object
+  const VuJSONValue *FirstChild(const VuJSONValue *parent) const;
+  const VuJSONValue *NextSibling(const VuJSONValue *parent, const VuJSONValue *child) const;
+
+  const VuJSONValue *Get(const VuJSONValue *object, const char *strKey) const;
+  // the key of an object member, as returned by FirstChild and NextSibling
+  static const char *GetKey(const VuJSONValue *member) { return (member - 1)->str; }
+  bool GetString(const VuJSONValue *object, const char *strKey, std::string &strValue) const;
+  bool GetInt(const VuJSONValue *object, const char *strKey, int &iValue) const;
+  bool GetBoolean(const VuJSONValue *object, const char *strKey, bool &bValue) const;
+
+private:
+  std::vector<VuJSONValue> m_values;
+  char *m_pos;
+  char *m_end;
+
+  bool ParseValue(void);
+  bool ParseString(const char *&str);
+  bool ParseLiteral(const char *strLiteral, VU_JSON_TYPE type, double value);
+  void SkipWhitespace(void);
+  unsigned int AddValue(VU_JSON_TYPE type);
+};
@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * Estimates of the heap memory held by the containers of the client.
+ * They count capacities and node sizes, allocator overhead is ignored.
+ */
+inline size_t VuStringBytes(const std::string &str)
+{
+  return str.capacity();
+}
+
+template<typename T> size_t VuVectorBytes(const std::vector<T> &v)
+{
+  return v.capacity() * sizeof(T);
+}
+
+// bucket array plus one node per element, a node links to the next one and caches the hash
+template<typename M> size_t VuHashBytes(const M &m)
+{
+  return m.bucket_count() * sizeof(void *) + m.size() * (sizeof(typename M::value_type) + 2 * sizeof(void *));
+}
+
+typedef enum VU_MEMORY_POOL
+{
+  VU_MEMORY_CHANNELS,
+  VU_MEMORY_GROUPS,
+  VU_MEMORY_INITIAL_EPG,
+  VU_MEMORY_TIMERS,
+  VU_MEMORY_RECORDINGS,
+  VU_MEMORY_EPG,
+  VU_MEMORY_EPG_COLD_INDEX,
+  VU_MEMORY_POOL_COUNT
+} VU_MEMORY_POOL;
+
+struct VuMemoryUsage
+{
+  size_t iBytes[VU_MEMORY_POOL_COUNT];
+  int64_t iDiskBytes; // live records of the cold EPG segment
+
+  VuMemoryUsage()
+  {
+    for (unsigned int i = 0; i < VU_MEMORY_POOL_COUNT; i++)
+      iBytes[i] = 0;
+    iDiskBytes = 0;
+  }
+
+  size_t GetTotal(void) const
+  {
+    size_t iTotal = 0;
+    for (unsigned int i = 0; i < VU_MEMORY_POOL_COUNT; i++)
+      iTotal += iBytes[i];
+    return iTotal;
+  }
+
+  static const char *GetName(VU_MEMORY_POOL pool)
+  {
+    switch (pool)
+    {
+      case VU_MEMORY_CHANNELS:        return "channels";
+      case VU_MEMORY_GROUPS:          return "channel groups";
+      case VU_MEMORY_INITIAL_EPG:     return "initial EPG";
+      case VU_MEMORY_TIMERS:          return "timers";
+      case VU_MEMORY_RECORDINGS:      return "recordings";
+      case VU_MEMORY_EPG:             return "EPG";
+      case VU_MEMORY_EPG_COLD_INDEX:  return "EPG disk index";
+      default:                        return "unknown";
+    }
+  }
+};
@@ -0,0 +1,84 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuRecordings.h"
+
+VuRecordingLocation::VuRecordingLocation(const std::string &strDirectory)
+{
+  m_strDirectory = strDirectory;
+  m_bLoaded = false;
+  m_iFingerprint = 0;
+}
+
+void VuRecordingLocation::SetFingerprint(unsigned int iFingerprint)
+{
+  m_iFingerprint = iFingerprint;
+  m_bLoaded = true;
+}
+
+void VuRecordingLocation::Add(const VuRecording &recording)
+{
+  m_index[recording.strRecordingId] = m_recordings.size();
+  m_recordings.push_back(recording);
+}
+
+const VuRecording *VuRecordingLocation::Find(const char *strRecordingId) const
+{
+  RecordingIndex::const_iterator it = m_index.find(VuStringRef(strRecordingId, strlen(strRecordingId)));
+  return (it != m_index.end()) ? &m_recordings[it->second] : NULL;
+}
+
+bool VuRecordingLocation::Remove(const char *strRecordingId)
+{
+  RecordingIndex::iterator it = m_index.find(VuStringRef(strRecordingId, strlen(strRecordingId)));
+  if (it == m_index.end())
+    return false;
+
+  // Kodi does not care about the order, the last recording takes the free place
+  unsigned int iRemoved = it->second;
+  m_index.erase(it);
+  if (iRemoved != m_recordings.size() - 1)
+  {
+    m_recordings[iRemoved] = m_recordings.back();
+    m_index[m_recordings[iRemoved].strRecordingId] = iRemoved;
+  }
+  m_recordings.pop_back();
+
+  return true;
+}
+
+void VuRecordingLocation::Replace(VuRecordingLocation &location)
+{
+  m_recordings.swap(location.m_recordings);
+  m_index.swap(location.m_index);
+  m_strings = std::move(location.m_strings);
+  location.m_recordings.clear();
+  location.m_index.clear();
+  m_iFingerprint = location.m_iFingerprint;
+  m_bLoaded = location.m_bLoaded;
+}
+
+size_t VuRecordingLocation::GetMemorySize(void) const
+{
+  return VuStringBytes(m_strDirectory) + VuVectorBytes(m_recordings) + VuHashBytes(m_index) + m_strings.GetSize();
+}
@@ -0,0 +1,84 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "VuArena.h"
+#include "VuMemory.h"
+
+// the strings point into the arena of the VuRecordingLocation holding the recording
+struct VuRecording
+{
+  VuStringRef strRecordingId;
+  time_t startTime;
+  int iDuration;
+  int iLastPlayedPosition;
+  VuStringRef strTitle;
+  VuStringRef strStreamURL;
+  VuStringRef strPlot;
+  VuStringRef strPlotOutline;
+  VuStringRef strChannelName;
+  VuStringRef strIconPath;
+};
+
+/*
+ * The recordings of one recording location on the receiver, indexed by
+ * their e2servicereference. Each location owns the strings of its
+ * recordings, so it can be reloaded without touching the others, and
+ * keeps a fingerprint of the movielist it was parsed from, so that an
+ * unchanged movielist does not have to be parsed again.
+ */
+class VuRecordingLocation
+{
+public:
+  VuRecordingLocation(const std::string &strDirectory);
+
+  const std::string &GetDirectory(void) const { return m_strDirectory; }
+  bool IsLoaded(void) const { return m_bLoaded; }
+  unsigned int GetFingerprint(void) const { return m_iFingerprint; }
+  void SetFingerprint(unsigned int iFingerprint);
+  VuStringArena &GetStrings(void) { return m_strings; }
+  const std::vector<VuRecording> &GetRecordings(void) const { return m_recordings; }
+  size_t GetMemorySize(void) const;
+
+  void Add(const VuRecording &recording);
+  const VuRecording *Find(const char *strRecordingId) const;
+  bool Remove(const char *strRecordingId);
+  // takes over the recordings and strings of a freshly parsed location
+  void Replace(VuRecordingLocation &location);
+
+private:
+  typedef std::unordered_map<VuStringRef, unsigned int, VuStringRefHash, VuStringRefEqual> RecordingIndex;
+
+  std::string m_strDirectory;
+  bool m_bLoaded;
+  unsigned int m_iFingerprint;
+  std::vector<VuRecording> m_recordings;
+  RecordingIndex m_index; // e2servicereference -> m_recordings index
+  VuStringArena m_strings;
+
+  VuRecordingLocation(const VuRecordingLocation &);
+  VuRecordingLocation &operator=(const VuRecordingLocation &);
+};
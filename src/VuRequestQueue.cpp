@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuRequestQueue.h"
+#include "client.h"
+
+using namespace ADDON;
+using namespace PLATFORM;
+
+VuRequestQueue::VuRequestQueue(void)
+{
+  m_iActive = 0;
+  for (int i = 0; i < VU_REQUEST_PRIORITIES; i++)
+    m_iWaiting[i] = 0;
+  m_iLimit = REQUEST_MAX_CONCURRENCY;
+  m_iFastResponses = 0;
+}
+
+bool VuRequestQueue::CanStart(VU_REQUEST_PRIORITY priority) const
+{
+  if (priority == VU_REQUEST_INTERACTIVE)
+    return true;
+
+  if (priority == VU_REQUEST_REFRESH)
+    return m_iActive < m_iLimit;
+
+  if (m_iWaiting[VU_REQUEST_REFRESH] > 0)
+    return false;
+
+  return m_iActive + 1 < m_iLimit || (m_iLimit == 1 && m_iActive == 0);
+}
+
+void VuRequestQueue::Acquire(VU_REQUEST_PRIORITY priority)
+{
+  CLockObject lock(m_mutex);
+
+  m_iWaiting[priority]++;
+  while (!CanStart(priority))
+    m_condition.Wait(m_mutex, 1000);
+  m_iWaiting[priority]--;
+
+  m_iActive++;
+}
+
+void VuRequestQueue::Release(VU_REQUEST_PRIORITY priority, unsigned int iLatency)
+{
+  CLockObject lock(m_mutex);
+
+  m_iActive--;
+
+  // interactive requests bypass the limit, so they don't say much about the load
+  if (priority != VU_REQUEST_INTERACTIVE)
+  {
+    if (iLatency > REQUEST_SLOW_LATENCY)
+    {
+      m_iFastResponses = 0;
+      if (m_iLimit > 1)
+      {
+        m_iLimit /= 2;
+        XBMC->Log(LOG_DEBUG, "%s Receiver answered in %u ms, reducing parallel requests to %u", __FUNCTION__, iLatency, m_iLimit);
+      }
+    }
+    else if (m_iLimit < REQUEST_MAX_CONCURRENCY && ++m_iFastResponses >= m_iLimit)
+    {
+      m_iFastResponses = 0;
+      m_iLimit++;
+      XBMC->Log(LOG_DEBUG, "%s Increasing parallel requests to %u", __FUNCTION__, m_iLimit);
+    }
+  }
+
+  m_condition.Broadcast();
+}
+
+unsigned int VuRequestQueue::GetLimit(void)
+{
+  CLockObject lock(m_mutex);
+  return m_iLimit;
+}
@@ -0,0 +1,65 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "platform/threads/threads.h"
+
+// upper bound for the number of parallel requests to the receiver
+#define REQUEST_MAX_CONCURRENCY  4
+// responses slower than this (in ms) make the queue back off
+#define REQUEST_SLOW_LATENCY  2000
+
+typedef enum VU_REQUEST_PRIORITY
+{
+  VU_REQUEST_INTERACTIVE, // zap, timer and recording changes
+  VU_REQUEST_REFRESH,     // data Kodi is waiting for
+  VU_REQUEST_BACKGROUND,  // periodic updates
+  VU_REQUEST_PRIORITIES
+} VU_REQUEST_PRIORITY;
+
+/*
+ * Admission control for the requests sent to the webinterface.
+ * Interactive requests are always let through, the others have to wait
+ * for a free slot and background requests additionally leave one slot
+ * for refreshes. The number of slots grows by one after a full round of
+ * fast responses and is halved when the receiver answers slowly.
+ */
+class VuRequestQueue
+{
+public:
+  VuRequestQueue(void);
+
+  void Acquire(VU_REQUEST_PRIORITY priority);
+  void Release(VU_REQUEST_PRIORITY priority, unsigned int iLatency);
+
+  unsigned int GetLimit(void);
+
+private:
+  PLATFORM::CMutex m_mutex;
+  PLATFORM::CCondition<bool> m_condition;
+  unsigned int m_iActive;
+  unsigned int m_iWaiting[VU_REQUEST_PRIORITIES];
+  unsigned int m_iLimit;
+  unsigned int m_iFastResponses;
+
+  bool CanStart(VU_REQUEST_PRIORITY priority) const;
+};
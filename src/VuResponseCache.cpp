@@ -0,0 +1,114 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuResponseCache.h"
+#include "platform/util/timeutils.h"
+#include <cstring>
+
+using namespace PLATFORM;
+
+VuResponseCache::VuResponseCache(void)
+{
+}
+
+bool VuResponseCache::Begin(const char *strURL, unsigned int iTTL, std::string &strResult, bool &bOk)
+{
+  CLockObject lock(m_mutex);
+
+  int64_t iNow = GetTimeMs();
+  RemoveExpired(iNow);
+
+  ResponseMap::iterator it = m_responses.find(VuStringRef(strURL, strlen(strURL)));
+  if (it == m_responses.end())
+  {
+    std::shared_ptr<VuResponse> response(new VuResponse);
+    response->bInFlight = true;
+    response->bOk = false;
+    response->iFetchTime = 0;
+    response->iTTL = iTTL;
+    response->strURL = strURL;
+    m_responses[VuStringRef(response->strURL.c_str(), response->strURL.length())] = response;
+    return true;
+  }
+
+  // hold on to the entry, it may be removed from the map while we wait
+  std::shared_ptr<VuResponse> response = it->second;
+  while (response->bInFlight)
+    m_condition.Wait(m_mutex, 1000);
+
+  strResult = response->strResult;
+  bOk = response->bOk;
+  return false;
+}
+
+void VuResponseCache::Finish(const char *strURL, const std::string &strResult, bool bOk)
+{
+  CLockObject lock(m_mutex);
+
+  ResponseMap::iterator it = m_responses.find(VuStringRef(strURL, strlen(strURL)));
+  if (it == m_responses.end())
+    return;
+
+  std::shared_ptr<VuResponse> response = it->second;
+  response->bInFlight = false;
+  response->bOk = bOk;
+  response->strResult = strResult;
+  response->iFetchTime = GetTimeMs();
+
+  // waiting callers still get the result, but failures are never cached
+  if (!bOk || response->iTTL == 0)
+    m_responses.erase(it);
+
+  m_condition.Broadcast();
+}
+
+void VuResponseCache::Invalidate(void)
+{
+  CLockObject lock(m_mutex);
+
+  ResponseMap::iterator it = m_responses.begin();
+  while (it != m_responses.end())
+  {
+    // a fetch started before the invalidation must not be kept afterwards
+    if (it->second->bInFlight)
+    {
+      it->second->iTTL = 0;
+      ++it;
+    }
+    else
+      it = m_responses.erase(it);
+  }
+}
+
+void VuResponseCache::RemoveExpired(int64_t iNow)
+{
+  ResponseMap::iterator it = m_responses.begin();
+  while (it != m_responses.end())
+  {
+    const VuResponse &response = *it->second;
+    if (!response.bInFlight && iNow - response.iFetchTime > response.iTTL)
+      it = m_responses.erase(it);
+    else
+      ++it;
+  }
+}
@@ -0,0 +1,66 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "platform/threads/threads.h"
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include "VuArena.h"
+
+/*
+ * Coalesces identical read requests to the webinterface. The first
+ * caller of an URL fetches it, callers arriving while that fetch is in
+ * flight wait for and share its result. Successful results are kept for
+ * a short time so bursts of identical requests are answered from memory.
+ */
+class VuResponseCache
+{
+public:
+  VuResponseCache(void);
+
+  // returns true if the caller has to fetch the URL and call Finish() afterwards
+  bool Begin(const char *strURL, unsigned int iTTL, std::string &strResult, bool &bOk);
+  void Finish(const char *strURL, const std::string &strResult, bool bOk);
+  void Invalidate(void);
+
+private:
+  struct VuResponse
+  {
+    bool bInFlight;
+    bool bOk;
+    int64_t iFetchTime;
+    unsigned int iTTL;
+    std::string strURL; // backs the key of the entry
+    std::string strResult;
+  };
+
+  // looked up by a view on the URL, so finding an entry does not copy it
+  typedef std::unordered_map<VuStringRef, std::shared_ptr<VuResponse>, VuStringRefHash, VuStringRefEqual> ResponseMap;
+
+  PLATFORM::CMutex m_mutex;
+  PLATFORM::CCondition<bool> m_condition;
+  ResponseMap m_responses;
+
+  void RemoveExpired(int64_t iNow);
+};
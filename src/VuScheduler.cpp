@@ -0,0 +1,178 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuScheduler.h"
+#include <cstdlib>
+#include <algorithm>
+
+using namespace PLATFORM;
+
+VuScheduler::VuScheduler(void)
+{
+  m_fTokens = 0;
+  m_fTokensPerSecond = 1;
+  m_iBurst = 1;
+  m_iLastRefill = 0;
+}
+
+void VuScheduler::AddTask(const std::string &strName, VU_TASK_PRIORITY priority, unsigned int iInterval, unsigned int iJitter, const Task &task)
+{
+  VuTask newTask;
+  newTask.strName = strName;
+  newTask.priority = priority;
+  newTask.iInterval = iInterval;
+  newTask.iJitter = iJitter;
+  newTask.iNextRun = NextRun(newTask, time(NULL));
+  newTask.iFailures = 0;
+  newTask.task = task;
+
+  m_tasks.push_back(newTask);
+}
+
+void VuScheduler::SetRateLimit(unsigned int iRunsPerMinute, unsigned int iBurst)
+{
+  m_fTokensPerSecond = iRunsPerMinute / 60.0;
+  m_iBurst = iBurst;
+  m_fTokens = iBurst;
+}
+
+void VuScheduler::RunSoon(const std::string &strName, time_t when)
+{
+  for (unsigned int i = 0; i < m_tasks.size(); i++)
+  {
+    if (m_tasks[i].strName == strName && m_tasks[i].iNextRun > when)
+      m_tasks[i].iNextRun = when;
+  }
+}
+
+bool VuScheduler::RunPendingTask(time_t now)
+{
+  if (m_iLastRefill != 0 && now > m_iLastRefill)
+  {
+    m_fTokens += (now - m_iLastRefill) * m_fTokensPerSecond;
+    if (m_fTokens > m_iBurst)
+      m_fTokens = m_iBurst;
+  }
+  m_iLastRefill = now;
+
+  if (m_fTokens < 1)
+    return false;
+
+  // the due task with the highest priority, the longest waiting one first
+  VuTask *pTask = NULL;
+  for (unsigned int i = 0; i < m_tasks.size(); i++)
+  {
+    VuTask &task = m_tasks[i];
+    if (task.iNextRun > now)
+      continue;
+
+    if (!pTask || task.priority < pTask->priority ||
+        (task.priority == pTask->priority && task.iNextRun < pTask->iNextRun))
+      pTask = &task;
+  }
+
+  if (!pTask)
+    return false;
+
+  pTask->iNextRun = NextRun(*pTask, now);
+
+  VU_TASK_RESULT result = pTask->task();
+  if (result == VU_TASK_IDLE)
+    return false;
+
+  m_fTokens -= 1;
+
+  if (result == VU_TASK_FAILED)
+  {
+    pTask->iFailures++;
+    pTask->iNextRun = std::max(pTask->iNextRun, NextRetry(*pTask, now));
+  }
+  else
+    pTask->iFailures = 0;
+
+  return true;
+}
+
+time_t VuScheduler::NextRun(const VuTask &task, time_t now) const
+{
+  time_t next = now + task.iInterval;
+  if (task.iJitter > 0)
+    next += rand() % (task.iJitter + 1);
+
+  return next;
+}
+
+time_t VuScheduler::NextRetry(const VuTask &task, time_t now) const
+{
+  time_t delay = SCHEDULER_RETRY_DELAY;
+  for (unsigned int i = 1; i < task.iFailures && delay < SCHEDULER_MAX_RETRY_DELAY; i++)
+    delay *= 2;
+
+  return now + std::min(delay, (time_t)SCHEDULER_MAX_RETRY_DELAY);
+}
+
+void VuTimerBoundaries::Clear(void)
+{
+  CLockObject lock(m_mutex);
+  m_boundaries = std::priority_queue<Boundary, std::vector<Boundary>, std::greater<Boundary> >();
+}
+
+void VuTimerBoundaries::Add(time_t when, bool bEnd)
+{
+  CLockObject lock(m_mutex);
+  m_boundaries.push(Boundary(when, bEnd));
+}
+
+bool VuTimerBoundaries::PopDue(time_t now, bool &bEnd)
+{
+  CLockObject lock(m_mutex);
+
+  if (m_boundaries.empty() || m_boundaries.top().first > now)
+    return false;
+
+  bEnd = m_boundaries.top().second;
+  m_boundaries.pop();
+  return true;
+}
+
+VuDeferredRun::VuDeferredRun(void)
+{
+  m_iDue = 0;
+}
+
+void VuDeferredRun::Request(time_t now, unsigned int iDelay)
+{
+  CLockObject lock(m_mutex);
+  m_iDue = now + iDelay;
+}
+
+bool VuDeferredRun::PopDue(time_t now)
+{
+  CLockObject lock(m_mutex);
+
+  if (m_iDue == 0 || m_iDue > now)
+    return false;
+
+  m_iDue = 0;
+  return true;
+}
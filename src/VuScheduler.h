@@ -0,0 +1,140 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <functional>
+#include <queue>
+#include "platform/threads/threads.h"
+
+// milliseconds the update thread sleeps between two scheduler runs
+#define SCHEDULER_TICK  250
+// runs of background tasks allowed to talk to the receiver
+#define SCHEDULER_RUNS_PER_MINUTE  60
+#define SCHEDULER_BURST  5
+// seconds a failed task waits before its next run, doubled with every further failure
+#define SCHEDULER_RETRY_DELAY  30
+#define SCHEDULER_MAX_RETRY_DELAY  (30 * 60)
+// seconds after a timer starts or ends until its new state is fetched
+#define TIMER_BOUNDARY_DELAY  15
+// timers and recordings are polled this many update intervals apart
+#define TIMER_POLL_FACTOR  5
+// seconds without further edits until timers or recordings are reloaded from the receiver
+#define RECONCILE_DELAY  30
+
+typedef enum VU_TASK_RESULT
+{
+  VU_TASK_IDLE,   // the receiver was not asked, e.g. because nothing was due
+  VU_TASK_DONE,
+  VU_TASK_FAILED  // the receiver was asked in vain
+} VU_TASK_RESULT;
+
+typedef enum VU_TASK_PRIORITY
+{
+  VU_TASK_PRIORITY_HIGH,
+  VU_TASK_PRIORITY_NORMAL,
+  VU_TASK_PRIORITY_LOW
+} VU_TASK_PRIORITY;
+
+/*
+ * Runs the background work of the update thread. Each task has a
+ * priority and an interval with some random jitter, so that periodic
+ * work of several clients does not hit the receiver at the same moment.
+ * All tasks share a token bucket that limits the number of runs which
+ * actually did some work (and therefore talked to the receiver), failed
+ * runs included. A task that failed backs off exponentially.
+ */
+class VuScheduler
+{
+public:
+  typedef std::function<VU_TASK_RESULT(void)> Task;
+
+  VuScheduler(void);
+
+  void AddTask(const std::string &strName, VU_TASK_PRIORITY priority, unsigned int iInterval, unsigned int iJitter, const Task &task);
+  void SetRateLimit(unsigned int iRunsPerMinute, unsigned int iBurst);
+  void RunSoon(const std::string &strName, time_t when);
+  bool RunPendingTask(time_t now);
+
+private:
+  struct VuTask
+  {
+    std::string strName;
+    VU_TASK_PRIORITY priority;
+    unsigned int iInterval;
+    unsigned int iJitter;
+    time_t iNextRun;
+    unsigned int iFailures; // failed runs in a row
+    Task task;
+  };
+
+  std::vector<VuTask> m_tasks;
+  double m_fTokens;
+  double m_fTokensPerSecond;
+  unsigned int m_iBurst;
+  time_t m_iLastRefill;
+
+  time_t NextRun(const VuTask &task, time_t now) const;
+  time_t NextRetry(const VuTask &task, time_t now) const;
+};
+
+/*
+ * A min-heap of the instants at which timers on the receiver start or
+ * end. The timer list is reloaded shortly after each of them, instead of
+ * waiting for the next poll to notice the new state. It is filled by
+ * whichever thread loads the timers and drained by the update thread.
+ */
+class VuTimerBoundaries
+{
+public:
+  void Clear(void);
+  void Add(time_t when, bool bEnd);
+  // pops the earliest instant not later than now, bEnd tells whether a timer ended there
+  bool PopDue(time_t now, bool &bEnd);
+
+private:
+  typedef std::pair<time_t, bool> Boundary;
+
+  PLATFORM::CMutex m_mutex;
+  std::priority_queue<Boundary, std::vector<Boundary>, std::greater<Boundary> > m_boundaries;
+};
+
+/*
+ * A single run of a task which is pushed back while new requests for it
+ * keep coming in, so that a burst of edits ends in one reload. Requested
+ * from any thread, popped by the update thread.
+ */
+class VuDeferredRun
+{
+public:
+  VuDeferredRun(void);
+
+  void Request(time_t now, unsigned int iDelay);
+  // true once the last request is iDelay seconds old
+  bool PopDue(time_t now);
+
+private:
+  PLATFORM::CMutex m_mutex;
+  time_t m_iDue; // 0 if no run is pending
+};
@@ -0,0 +1,205 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuServiceRef.h"
+#include <cstring>
+
+using namespace PLATFORM;
+
+// 32 bit FNV-1a
+static unsigned int HashBytes(unsigned int iHash, const void *pData, size_t iLength)
+{
+  const unsigned char *p = (const unsigned char *)pData;
+  for (size_t i = 0; i < iLength; i++)
+  {
+    iHash ^= p[i];
+    iHash *= 16777619u;
+  }
+  return iHash;
+}
+
+static bool ParseField(const char *&p, const char *pEnd, unsigned int iBase, unsigned int &iValue)
+{
+  const char *pStart = p;
+  iValue = 0;
+
+  for (; p < pEnd && *p != ':'; p++)
+  {
+    unsigned int iDigit;
+    if (*p >= '0' && *p <= '9')
+      iDigit = *p - '0';
+    else if (iBase == 16 && *p >= 'a' && *p <= 'f')
+      iDigit = *p - 'a' + 10;
+    else if (iBase == 16 && *p >= 'A' && *p <= 'F')
+      iDigit = *p - 'A' + 10;
+    else
+      return false;
+
+    iValue = iValue * iBase + iDigit;
+  }
+
+  if (p == pStart || p == pEnd)
+    return false;
+
+  p++; // skip the colon
+  return true;
+}
+
+static char *FormatField(char *p, unsigned int iValue, unsigned int iBase)
+{
+  static const char digits[] = "0123456789ABCDEF";
+  char reversed[16];
+  int iDigits = 0;
+
+  do
+  {
+    reversed[iDigits++] = digits[iValue % iBase];
+    iValue /= iBase;
+  } while (iValue != 0);
+
+  while (iDigits > 0)
+    *p++ = reversed[--iDigits];
+
+  return p;
+}
+
+VuServiceRef::VuServiceRef(void)
+{
+  iType = iFlags = iServiceType = iSID = iTSID = iONID = 0;
+  iNamespace = iParentSID = iParentTSID = iUnused = 0;
+}
+
+bool VuServiceRef::Parse(const char *strServiceReference, size_t iLength, VuServiceRef &ref)
+{
+  const char *p = strServiceReference;
+  const char *pEnd = strServiceReference + iLength;
+
+  unsigned int *fields[10] = { &ref.iType, &ref.iFlags, &ref.iServiceType, &ref.iSID, &ref.iTSID,
+                               &ref.iONID, &ref.iNamespace, &ref.iParentSID, &ref.iParentTSID, &ref.iUnused };
+
+  for (int i = 0; i < 10; i++)
+  {
+    if (!ParseField(p, pEnd, i < 2 ? 10 : 16, *fields[i]))
+      return false;
+  }
+
+  ref.strPath = VuStringRef(p, pEnd - p);
+  return true;
+}
+
+size_t VuServiceRef::FormatId(char *strBuffer, char cSeparator) const
+{
+  const unsigned int fields[10] = { iType, iFlags, iServiceType, iSID, iTSID,
+                                    iONID, iNamespace, iParentSID, iParentTSID, iUnused };
+
+  char *p = strBuffer;
+  for (int i = 0; i < 10; i++)
+  {
+    if (i > 0)
+      *p++ = cSeparator;
+    p = FormatField(p, fields[i], i < 2 ? 10 : 16);
+  }
+  *p = '\0';
+
+  return p - strBuffer;
+}
+
+std::string VuServiceRef::ToString(void) const
+{
+  char strId[SERVICE_REF_ID_SIZE];
+  size_t iLength = FormatId(strId, ':');
+
+  std::string strResult;
+  strResult.reserve(iLength + 1 + strPath.length());
+  strResult.append(strId, iLength);
+  strResult += ':';
+  strResult.append(strPath.c_str(), strPath.length());
+  return strResult;
+}
+
+size_t VuServiceRef::Hash(void) const
+{
+  const unsigned int fields[10] = { iType, iFlags, iServiceType, iSID, iTSID,
+                                    iONID, iNamespace, iParentSID, iParentTSID, iUnused };
+
+  unsigned int iHash = HashBytes(2166136261u, fields, sizeof(fields));
+  return HashBytes(iHash, strPath.c_str(), strPath.length());
+}
+
+bool VuServiceRef::operator==(const VuServiceRef &right) const
+{
+  return iType == right.iType && iFlags == right.iFlags && iServiceType == right.iServiceType &&
+         iSID == right.iSID && iTSID == right.iTSID && iONID == right.iONID &&
+         iNamespace == right.iNamespace && iParentSID == right.iParentSID &&
+         iParentTSID == right.iParentTSID && iUnused == right.iUnused &&
+         strPath.length() == right.strPath.length() &&
+         memcmp(strPath.c_str(), right.strPath.c_str(), strPath.length()) == 0;
+}
+
+VuServiceRefTable::VuServiceRefTable(void)
+{
+  m_refs.push_back(VuStringRef());
+  m_ids[VuStringRef()] = SERVICE_REF_NONE;
+}
+
+unsigned int VuServiceRefTable::Intern(const char *strServiceReference, size_t iLength)
+{
+  CLockObject lock(m_mutex);
+
+  std::unordered_map<VuStringRef, unsigned int, VuStringRefHash, VuStringRefEqual>::const_iterator it = m_ids.find(VuStringRef(strServiceReference, iLength));
+  if (it != m_ids.end())
+    return it->second;
+
+  unsigned int iId = m_refs.size();
+  VuStringRef str = m_strings.Add(strServiceReference, iLength);
+  m_refs.push_back(str);
+  m_ids[str] = iId;
+  return iId;
+}
+
+unsigned int VuServiceRefTable::Intern(const char *strServiceReference)
+{
+  return Intern(strServiceReference, strlen(strServiceReference));
+}
+
+unsigned int VuServiceRefTable::Find(const std::string &strServiceReference) const
+{
+  CLockObject lock(m_mutex);
+
+  std::unordered_map<VuStringRef, unsigned int, VuStringRefHash, VuStringRefEqual>::const_iterator it = m_ids.find(VuStringRef(strServiceReference.c_str(), strServiceReference.length()));
+  return it != m_ids.end() ? it->second : SERVICE_REF_NONE;
+}
+
+VuStringRef VuServiceRefTable::Get(unsigned int iId) const
+{
+  CLockObject lock(m_mutex);
+
+  return iId < m_refs.size() ? m_refs[iId] : VuStringRef();
+}
+
+size_t VuServiceRefTable::GetMemorySize(void) const
+{
+  CLockObject lock(m_mutex);
+
+  return m_strings.GetSize() + VuVectorBytes(m_refs) + VuHashBytes(m_ids);
+}
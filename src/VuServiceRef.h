@@ -0,0 +1,105 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "platform/threads/threads.h"
+#include "VuArena.h"
+#include "VuMemory.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// id of the empty service reference
+#define SERVICE_REF_NONE  0
+
+// flags of an Enigma2 service reference
+#define SERVICE_REF_FLAG_DIRECTORY  7
+#define SERVICE_REF_FLAG_MARKER     64
+
+// room for the ten numeric fields of a service reference, separators included
+#define SERVICE_REF_ID_SIZE  96
+
+/*
+ * An Enigma2 service reference such as "1:0:19:283D:3FB:1:C00000:0:0:0:"
+ * split into its fields. type and flags are decimal, the remaining eight
+ * fields hexadecimal. Everything after the tenth colon is the path, e.g.
+ * the bouquet query or the file of a recording. Parsing does not copy
+ * the path, it points into the parsed string.
+ */
+struct VuServiceRef
+{
+  unsigned int iType;
+  unsigned int iFlags;
+  unsigned int iServiceType;
+  unsigned int iSID;
+  unsigned int iTSID;
+  unsigned int iONID;
+  unsigned int iNamespace;
+  unsigned int iParentSID;
+  unsigned int iParentTSID;
+  unsigned int iUnused;
+  VuStringRef strPath;
+
+  VuServiceRef(void);
+
+  static bool Parse(const char *strServiceReference, size_t iLength, VuServiceRef &ref);
+  static bool Parse(const std::string &strServiceReference, VuServiceRef &ref) { return Parse(strServiceReference.c_str(), strServiceReference.length(), ref); }
+
+  // the numeric fields joined by cSeparator, e.g. "1_0_19_283D_3FB_1_C00000_0_0_0"
+  // for picon names; returns the length written, strBuffer needs SERVICE_REF_ID_SIZE bytes
+  size_t FormatId(char *strBuffer, char cSeparator) const;
+  // the complete reference as Enigma2 prints it
+  std::string ToString(void) const;
+
+  bool IsMarker(void) const { return (iFlags & SERVICE_REF_FLAG_MARKER) != 0; }
+  bool IsDirectory(void) const { return (iFlags & SERVICE_REF_FLAG_DIRECTORY) == SERVICE_REF_FLAG_DIRECTORY; }
+
+  size_t Hash(void) const;
+  bool operator==(const VuServiceRef &right) const;
+  bool operator!=(const VuServiceRef &right) const { return !(*this == right); }
+};
+
+/*
+ * Interns service references. Channels, EPG entries and timers store the
+ * returned id instead of the string, so joins between them compare and
+ * hash integers. Ids are never reused, the table only grows with the
+ * number of distinct services seen on the receiver.
+ */
+class VuServiceRefTable
+{
+public:
+  VuServiceRefTable(void);
+
+  unsigned int Intern(const char *strServiceReference, size_t iLength);
+  unsigned int Intern(const char *strServiceReference);
+  unsigned int Intern(const std::string &strServiceReference) { return Intern(strServiceReference.c_str(), strServiceReference.length()); }
+  // returns SERVICE_REF_NONE if the reference was never interned
+  unsigned int Find(const std::string &strServiceReference) const;
+  VuStringRef Get(unsigned int iId) const;
+  size_t GetMemorySize(void) const;
+
+private:
+  mutable PLATFORM::CMutex m_mutex;
+  VuStringArena m_strings;
+  std::vector<VuStringRef> m_refs; // id -> service reference
+  std::unordered_map<VuStringRef, unsigned int, VuStringRefHash, VuStringRefEqual> m_ids;
+};
@@ -0,0 +1,211 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuTimers.h"
+#include <cstring>
+
+void VuTimer::ToTag(PVR_TIMER &tag) const
+{
+  memset(&tag, 0, sizeof(PVR_TIMER));
+  tag.iClientChannelUid = iChannelId;
+  tag.startTime         = startTime;
+  tag.endTime           = endTime;
+  strncpy(tag.strTitle, strTitle.c_str(), sizeof(tag.strTitle));
+  strncpy(tag.strDirectory, "/", sizeof(tag.strDirectory));   // unused
+  strncpy(tag.strSummary, strPlot.c_str(), sizeof(tag.strSummary));
+  tag.state             = state;
+  tag.iPriority         = 0;     // unused
+  tag.iLifetime         = 0;     // unused
+  tag.bIsRepeating      = bRepeating;
+  tag.firstDay          = 0;     // unused
+  tag.iWeekdays         = iWeekdays;
+  tag.iEpgUid           = iEpgID;
+  tag.iMarginStart      = 0;     // unused
+  tag.iMarginEnd        = 0;     // unused
+  tag.iGenreType        = 0;     // unused
+  tag.iGenreSubType     = 0;     // unused
+  tag.iClientIndex = iClientIndex;
+}
+
+VuTimerMap::VuTimerMap(void)
+{
+  m_iSize = 0;
+}
+
+unsigned int VuTimerMap::Add(const VuTimer &timer)
+{
+  unsigned int iSlot;
+  if (!m_freeSlots.empty())
+  {
+    iSlot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+  }
+  else
+  {
+    iSlot = m_slots.size();
+    m_slots.push_back(Slot());
+    m_slots.back().iGeneration = 0;
+  }
+
+  Slot &slot = m_slots[iSlot];
+  // generation 0 is skipped, so that no client index is 0
+  slot.iGeneration = (slot.iGeneration + 1) & (~0u >> TIMER_SLOT_BITS);
+  if (slot.iGeneration == 0)
+    slot.iGeneration = 1;
+  slot.bUsed = true;
+  slot.bTagValid = false;
+  slot.timer = timer;
+  slot.timer.iClientIndex = (slot.iGeneration << TIMER_SLOT_BITS) | iSlot;
+
+  AddToIndexes(slot.timer);
+  m_iSize++;
+
+  return slot.timer.iClientIndex;
+}
+
+bool VuTimerMap::Remove(unsigned int iClientIndex)
+{
+  Slot *slot = GetSlot(iClientIndex);
+  if (!slot)
+    return false;
+
+  RemoveFromIndexes(slot->timer);
+  slot->bUsed = false;
+  slot->timer = VuTimer();
+  m_freeSlots.push_back(iClientIndex & TIMER_SLOT_MASK);
+  m_iSize--;
+
+  return true;
+}
+
+bool VuTimerMap::Update(unsigned int iClientIndex, const VuTimer &timer)
+{
+  Slot *slot = GetSlot(iClientIndex);
+  if (!slot)
+    return false;
+
+  RemoveFromIndexes(slot->timer);
+  slot->timer = timer;
+  slot->timer.iClientIndex = iClientIndex;
+  slot->bTagValid = false;
+  AddToIndexes(slot->timer);
+
+  return true;
+}
+
+void VuTimerMap::Clear(void)
+{
+  // the generations survive, indexes handed out before stay invalid
+  for (unsigned int i = 0; i < m_slots.size(); i++)
+  {
+    if (m_slots[i].bUsed)
+    {
+      m_slots[i].bUsed = false;
+      m_slots[i].timer = VuTimer();
+      m_freeSlots.push_back(i);
+    }
+  }
+
+  m_byServiceRef.clear();
+  m_byEvent.clear();
+  m_iSize = 0;
+}
+
+VuTimer *VuTimerMap::Get(unsigned int iClientIndex)
+{
+  Slot *slot = GetSlot(iClientIndex);
+  return slot ? &slot->timer : NULL;
+}
+
+unsigned int VuTimerMap::FindByEvent(unsigned int iServiceRef, int iEpgID) const
+{
+  std::unordered_map<unsigned long long, unsigned int>::const_iterator it = m_byEvent.find(EventKey(iServiceRef, iEpgID));
+  return (it != m_byEvent.end()) ? it->second : 0;
+}
+
+void VuTimerMap::FindByServiceRef(unsigned int iServiceRef, std::vector<unsigned int> &clientIndexes) const
+{
+  auto range = m_byServiceRef.equal_range(iServiceRef);
+  for (auto it = range.first; it != range.second; ++it)
+    clientIndexes.push_back(it->second);
+}
+
+void VuTimerMap::GetClientIndexes(std::vector<unsigned int> &clientIndexes) const
+{
+  clientIndexes.reserve(clientIndexes.size() + m_iSize);
+  ForEach([&clientIndexes](const VuTimer &timer) { clientIndexes.push_back(timer.iClientIndex); });
+}
+
+VuTimerMap::Slot *VuTimerMap::GetSlot(unsigned int iClientIndex)
+{
+  unsigned int iSlot = iClientIndex & TIMER_SLOT_MASK;
+  if (iSlot >= m_slots.size())
+    return NULL;
+
+  Slot &slot = m_slots[iSlot];
+  if (!slot.bUsed || slot.timer.iClientIndex != iClientIndex)
+    return NULL;
+
+  return &slot;
+}
+
+void VuTimerMap::AddToIndexes(const VuTimer &timer)
+{
+  m_byServiceRef.insert(std::make_pair(timer.iServiceRef, timer.iClientIndex));
+  // cancelled and finished timers don't keep the event from being scheduled again
+  if (timer.iEpgID > 0 && (timer.state == PVR_TIMER_STATE_SCHEDULED || timer.state == PVR_TIMER_STATE_RECORDING))
+    m_byEvent[EventKey(timer.iServiceRef, timer.iEpgID)] = timer.iClientIndex;
+}
+
+void VuTimerMap::RemoveFromIndexes(const VuTimer &timer)
+{
+  auto range = m_byServiceRef.equal_range(timer.iServiceRef);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second == timer.iClientIndex)
+    {
+      m_byServiceRef.erase(it);
+      break;
+    }
+  }
+
+  if (timer.iEpgID > 0)
+  {
+    auto it = m_byEvent.find(EventKey(timer.iServiceRef, timer.iEpgID));
+    if (it != m_byEvent.end() && it->second == timer.iClientIndex)
+      m_byEvent.erase(it);
+  }
+}
+
+size_t VuTimerMap::GetMemorySize(void) const
+{
+  size_t iSize = VuVectorBytes(m_slots) + VuVectorBytes(m_freeSlots) + VuHashBytes(m_byServiceRef) + VuHashBytes(m_byEvent);
+  for (unsigned int i = 0; i < m_slots.size(); i++)
+    iSize += VuStringBytes(m_slots[i].timer.strTitle) + VuStringBytes(m_slots[i].timer.strPlot);
+  return iSize;
+}
+
+unsigned long long VuTimerMap::EventKey(unsigned int iServiceRef, int iEpgID)
+{
+  return ((unsigned long long)iServiceRef << 32) | (unsigned int)iEpgID;
+}
@@ -0,0 +1,170 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "kodi/libXBMC_pvr.h"
+#include "VuMemory.h"
+
+// the low bits of a timer client index select its slot, the others count the reuses of the slot
+#define TIMER_SLOT_BITS  16
+#define TIMER_SLOT_MASK  ((1u << TIMER_SLOT_BITS) - 1)
+
+typedef enum VU_UPDATE_STATE
+{
+    VU_UPDATE_STATE_NONE,
+    VU_UPDATE_STATE_FOUND,
+    VU_UPDATE_STATE_UPDATED,
+    VU_UPDATE_STATE_NEW
+} VU_UPDATE_STATE;
+
+struct VuTimer
+{
+  std::string strTitle;
+  std::string strPlot;
+  int iChannelId;
+  unsigned int iServiceRef;
+  time_t startTime;
+  time_t endTime;
+  bool bRepeating; 
+  int iWeekdays;
+  int iEpgID;
+  PVR_TIMER_STATE state; 
+  int iUpdateState;
+  unsigned int iClientIndex;
+
+  VuTimer()
+  {
+    iUpdateState = VU_UPDATE_STATE_NEW;
+  }
+
+  void ToTag(PVR_TIMER &tag) const;
+  
+  bool like(const VuTimer &right) const
+  {
+    bool bChanged = true;
+    bChanged = bChanged && (startTime == right.startTime); 
+    bChanged = bChanged && (endTime == right.endTime); 
+    bChanged = bChanged && (iChannelId == right.iChannelId); 
+    bChanged = bChanged && (bRepeating == right.bRepeating); 
+    bChanged = bChanged && (iWeekdays == right.iWeekdays); 
+    bChanged = bChanged && (iEpgID == right.iEpgID); 
+
+    return bChanged;
+  }
+  
+  bool operator==(const VuTimer &right) const
+  {
+    bool bChanged = true;
+    bChanged = bChanged && (startTime == right.startTime); 
+    bChanged = bChanged && (endTime == right.endTime); 
+    bChanged = bChanged && (iChannelId == right.iChannelId); 
+    bChanged = bChanged && (bRepeating == right.bRepeating); 
+    bChanged = bChanged && (iWeekdays == right.iWeekdays); 
+    bChanged = bChanged && (iEpgID == right.iEpgID); 
+    bChanged = bChanged && (state == right.state); 
+    bChanged = bChanged && (! strTitle.compare(right.strTitle));
+    bChanged = bChanged && (! strPlot.compare(right.strPlot));
+
+    return bChanged;
+  }
+};
+
+/*
+ * The timers known to Kodi, stored in reusable slots. The client index
+ * handed to Kodi is the slot number plus a generation, so a lookup is a
+ * plain array access and a stale index of a removed timer never matches
+ * the timer that reuses its slot. Secondary indexes find the timers of a
+ * service and the timer recording a given EPG event. Every slot keeps the
+ * PVR_TIMER last handed to Kodi, which is rebuilt only after the timer
+ * was replaced, so changes Kodi has to see must go through Update().
+ */
+class VuTimerMap
+{
+public:
+  VuTimerMap(void);
+
+  // stores the timer and returns its new client index
+  unsigned int Add(const VuTimer &timer);
+  bool Remove(unsigned int iClientIndex);
+  // replaces the timer stored under iClientIndex, keeping the index
+  bool Update(unsigned int iClientIndex, const VuTimer &timer);
+  void Clear(void);
+
+  VuTimer *Get(unsigned int iClientIndex);
+  // the scheduled or recording timer of an event, 0 if there is none
+  unsigned int FindByEvent(unsigned int iServiceRef, int iEpgID) const;
+  void FindByServiceRef(unsigned int iServiceRef, std::vector<unsigned int> &clientIndexes) const;
+  void GetClientIndexes(std::vector<unsigned int> &clientIndexes) const;
+  unsigned int Size(void) const { return m_iSize; }
+  size_t GetMemorySize(void) const;
+
+  template<typename F> void ForEach(F f) const
+  {
+    for (unsigned int i = 0; i < m_slots.size(); i++)
+    {
+      if (m_slots[i].bUsed)
+        f(m_slots[i].timer);
+    }
+  }
+
+  template<typename F> void ForEachTag(F f)
+  {
+    for (unsigned int i = 0; i < m_slots.size(); i++)
+    {
+      Slot &slot = m_slots[i];
+      if (!slot.bUsed)
+        continue;
+
+      if (!slot.bTagValid)
+      {
+        slot.timer.ToTag(slot.tag);
+        slot.bTagValid = true;
+      }
+      f(slot.tag);
+    }
+  }
+
+private:
+  struct Slot
+  {
+    VuTimer timer;
+    unsigned int iGeneration;
+    bool bUsed;
+    bool bTagValid;
+    PVR_TIMER tag;
+  };
+
+  std::vector<Slot> m_slots;
+  std::vector<unsigned int> m_freeSlots;
+  unsigned int m_iSize;
+  std::unordered_multimap<unsigned int, unsigned int> m_byServiceRef; // service reference id -> client index
+  std::unordered_map<unsigned long long, unsigned int> m_byEvent; // service reference id and event id -> client index of the scheduled or recording timer
+
+  Slot *GetSlot(unsigned int iClientIndex);
+  void AddToIndexes(const VuTimer &timer);
+  void RemoveFromIndexes(const VuTimer &timer);
+  static unsigned long long EventKey(unsigned int iServiceRef, int iEpgID);
+};
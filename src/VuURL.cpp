@@ -0,0 +1,150 @@
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "VuURL.h"
+#include <cstring>
+#include <cstdio>
+
+static const char DEC2HEX[16 + 1] = "0123456789ABCDEF";
+
+static const char SAFE[256] =
+{
+    /*      0 1 2 3  4 5 6 7  8 9 A B  C D E F */
+    /* 0 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* 1 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* 2 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* 3 */ 1,1,1,1, 1,1,1,1, 1,1,0,0, 0,0,0,0,
+
+    /* 4 */ 0,1,1,1, 1,1,1,1, 1,1,1,1, 1,1,1,1,
+    /* 5 */ 1,1,1,1, 1,1,1,1, 1,1,1,0, 0,0,0,0,
+    /* 6 */ 0,1,1,1, 1,1,1,1, 1,1,1,1, 1,1,1,1,
+    /* 7 */ 1,1,1,1, 1,1,1,1, 1,1,1,0, 0,0,0,0,
+
+    /* 8 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* 9 */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* A */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* B */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+
+    /* C */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* D */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* E */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0,
+    /* F */ 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0
+};
+
+// writes the encoded form of str to pDest, which needs room for 3 * iLength bytes
+static char *EncodeTo(char *pDest, const char *str, size_t iLength)
+{
+  const unsigned char *pSrc = (const unsigned char *)str;
+  const unsigned char *pSrcEnd = pSrc + iLength;
+
+  for (; pSrc < pSrcEnd; ++pSrc)
+  {
+    if (SAFE[*pSrc])
+      *pDest++ = *pSrc;
+    else
+    {
+      // escape this char
+      *pDest++ = '%';
+      *pDest++ = DEC2HEX[*pSrc >> 4];
+      *pDest++ = DEC2HEX[*pSrc & 0x0F];
+    }
+  }
+
+  return pDest;
+}
+
+VuURL::VuURL(void)
+{
+  m_pData = m_inline;
+  m_iLength = 0;
+  m_iCapacity = URL_INLINE_SIZE;
+  m_inline[0] = '\0';
+}
+
+VuURL::VuURL(const std::string &strBase)
+{
+  m_pData = m_inline;
+  m_iLength = 0;
+  m_iCapacity = URL_INLINE_SIZE;
+  m_inline[0] = '\0';
+  Append(strBase);
+}
+
+void VuURL::Reserve(size_t iAdditional)
+{
+  if (m_iLength + iAdditional + 1 <= m_iCapacity)
+    return;
+
+  size_t iCapacity = m_iCapacity * 2;
+  while (m_iLength + iAdditional + 1 > iCapacity)
+    iCapacity *= 2;
+
+  std::unique_ptr<char[]> heap(new char[iCapacity]);
+  memcpy(heap.get(), m_pData, m_iLength + 1);
+  m_heap.swap(heap);
+  m_pData = m_heap.get();
+  m_iCapacity = iCapacity;
+}
+
+VuURL &VuURL::Append(const char *str, size_t iLength)
+{
+  Reserve(iLength);
+  memcpy(m_pData + m_iLength, str, iLength);
+  m_iLength += iLength;
+  m_pData[m_iLength] = '\0';
+  return *this;
+}
+
+VuURL &VuURL::Append(const char *str)
+{
+  return Append(str, strlen(str));
+}
+
+VuURL &VuURL::AppendEncoded(const char *str, size_t iLength)
+{
+  Reserve(iLength * 3);
+  char *pEnd = EncodeTo(m_pData + m_iLength, str, iLength);
+  m_iLength = pEnd - m_pData;
+  m_pData[m_iLength] = '\0';
+  return *this;
+}
+
+VuURL &VuURL::AppendEncoded(const char *str)
+{
+  return AppendEncoded(str, strlen(str));
+}
+
+VuURL &VuURL::AppendInt(long long iValue)
+{
+  char strValue[24];
+  int iLength = snprintf(strValue, sizeof(strValue), "%lld", iValue);
+  return Append(strValue, iLength);
+}
+
+void VuURL::Encode(const char *str, size_t iLength, std::string &strResult)
+{
+  strResult.resize(iLength * 3);
+  char *pStart = &strResult[0];
+  char *pEnd = EncodeTo(pStart, str, iLength);
+  strResult.resize(pEnd - pStart);
+}
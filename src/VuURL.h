@@ -0,0 +1,66 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <cstddef>
+#include <string>
+#include <memory>
+
+// URLs up to this length are built without touching the heap
+#define URL_INLINE_SIZE  512
+
+/*
+ * Builds a webinterface URL in a buffer on the stack, only URLs longer
+ * than URL_INLINE_SIZE (e.g. timers with a long description) spill to
+ * the heap. Query values are percent-encoded while appending.
+ */
+class VuURL
+{
+public:
+  VuURL(void);
+  explicit VuURL(const std::string &strBase);
+
+  VuURL &Append(const char *str, size_t iLength);
+  VuURL &Append(const char *str);
+  VuURL &Append(const std::string &str) { return Append(str.c_str(), str.length()); }
+  VuURL &AppendEncoded(const char *str, size_t iLength);
+  VuURL &AppendEncoded(const char *str);
+  VuURL &AppendEncoded(const std::string &str) { return AppendEncoded(str.c_str(), str.length()); }
+  VuURL &AppendInt(long long iValue);
+
+  const char *c_str(void) const { return m_pData; }
+  size_t length(void) const { return m_iLength; }
+
+  static void Encode(const char *str, size_t iLength, std::string &strResult);
+
+private:
+  char m_inline[URL_INLINE_SIZE];
+  std::unique_ptr<char[]> m_heap;
+  char *m_pData;
+  size_t m_iLength;
+  size_t m_iCapacity;
+
+  void Reserve(size_t iAdditional);
+
+  VuURL(const VuURL &);
+  VuURL &operator=(const VuURL &);
+};
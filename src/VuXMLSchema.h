@@ -0,0 +1,170 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2015 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1335, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include "tinyxml.h"
+#include "VuJSON.h"
+
+// FNV-1a, usable at compile time to hash the tag names of a field table
+constexpr unsigned int VuXMLHash(const char *str, unsigned int iHash = 2166136261u)
+{
+  return *str ? VuXMLHash(str + 1, (iHash ^ (unsigned char)*str) * 16777619u) : iHash;
+}
+
+/*
+ * Binds the name of a child element of an e2 record (e.g. <e2event>) and
+ * the key of the same value in the JSON records of the OpenWebif api to
+ * the code storing its text in a record of type T. A loader declares one
+ * static table of fields per record type and reads each element with a
+ * single pass over its children, instead of looking up every field with
+ * XMLUtils, which rescans the children for each call. Both backends go
+ * through the same table, so they cannot disagree on a field.
+ */
+template <typename T>
+struct VuXMLField
+{
+  const char *strTag;
+  unsigned int iHash;
+  const char *strKey; // empty if the api has no such value
+  unsigned int iKeyHash;
+  bool bRequired;
+  void (*Set)(T &record, const char *strValue);
+};
+
+#define VU_XML_FIELD(tag, key, required, setter)  { tag, VuXMLHash(tag), key, VuXMLHash(key), required, setter }
+
+inline int VuXMLToInt(const char *strValue)
+{
+  return atoi(strValue);
+}
+
+inline bool VuXMLToBool(const char *strValue)
+{
+  return !strcasecmp(strValue, "true") || !strcasecmp(strValue, "yes") || !strcmp(strValue, "1");
+}
+
+// whether every required field is in the mask of the fields found
+template <typename T, size_t N>
+bool VuFieldsComplete(const VuXMLField<T> (&fields)[N], unsigned int iFound)
+{
+  for (size_t i = 0; i < N; i++)
+  {
+    if (fields[i].bRequired && !(iFound & (1u << i)))
+      return false;
+  }
+
+  return true;
+}
+
+// the text of a JSON value as the setters expect it, NULL for null, arrays and objects
+inline const char *VuJSONToText(const VuJSONValue *value, char *strBuffer, size_t iSize)
+{
+  switch (value->type)
+  {
+    case VU_JSON_STRING:
+      return value->str;
+    case VU_JSON_BOOL:
+      return value->number != 0 ? "1" : "0";
+    case VU_JSON_NUMBER:
+      if (value->number > -1e18 && value->number < 1e18 && value->number == (double)(long long)value->number)
+        snprintf(strBuffer, iSize, "%lld", (long long)value->number);
+      else
+        snprintf(strBuffer, iSize, "%g", value->number);
+      return strBuffer;
+    default:
+      return NULL;
+  }
+}
+
+/*
+ * Fills record from the children of pNode. Returns false if one of the
+ * required fields is missing.
+ */
+template <typename T, size_t N>
+bool VuXMLRead(const TiXmlElement *pNode, const VuXMLField<T> (&fields)[N], T &record)
+{
+  static_assert(N <= 32, "too many fields for the found mask");
+
+  unsigned int iFound = 0;
+
+  for (const TiXmlElement *pChild = pNode->FirstChildElement(); pChild != NULL; pChild = pChild->NextSiblingElement())
+  {
+    const char *strTag = pChild->Value();
+    unsigned int iHash = VuXMLHash(strTag);
+
+    for (size_t i = 0; i < N; i++)
+    {
+      if (fields[i].iHash != iHash || strcmp(fields[i].strTag, strTag) != 0)
+        continue;
+
+      const TiXmlNode *pText = pChild->FirstChild();
+      fields[i].Set(record, pText ? pText->Value() : "");
+      iFound |= 1u << i;
+      break;
+    }
+  }
+
+  return VuFieldsComplete(fields, iFound);
+}
+
+/*
+ * Fills record from the members of the JSON object node, matched by the
+ * keys of the fields. Returns false if one of the required fields is
+ * missing.
+ */
+template <typename T, size_t N>
+bool VuJSONRead(const VuJSONDocument &doc, const VuJSONValue *node, const VuXMLField<T> (&fields)[N], T &record)
+{
+  static_assert(N <= 32, "too many fields for the found mask");
+
+  if (node->type != VU_JSON_OBJECT)
+    return false;
+
+  unsigned int iFound = 0;
+  char strNumber[32];
+
+  for (const VuJSONValue *value = doc.FirstChild(node); value != NULL; value = doc.NextSibling(node, value))
+  {
+    const char *strKey = VuJSONDocument::GetKey(value);
+    unsigned int iHash = VuXMLHash(strKey);
+
+    for (size_t i = 0; i < N; i++)
+    {
+      if (fields[i].iKeyHash != iHash || strcmp(fields[i].strKey, strKey) != 0)
+        continue;
+
+      const char *strValue = VuJSONToText(value, strNumber, sizeof(strNumber));
+      if (strValue)
+      {
+        fields[i].Set(record, strValue);
+        iFound |= 1u << i;
+      }
+      break;
+    }
+  }
+
+  return VuFieldsComplete(fields, iFound);
+}
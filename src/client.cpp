@@ -43,6 +43,10 @@ int         g_iConnectTimeout         = DEFAULT_CONNECT_TIMEOUT;
 int         g_iPortStream             = DEFAULT_STREAM_PORT;
 int         g_iPortWeb                = DEFAULT_WEB_PORT;
 int         g_iUpdateInterval         = DEFAULT_UPDATE_INTERVAL;
+int         g_iRequestCacheTTL        = DEFAULT_REQUEST_CACHE_TTL;
+int         g_iEPGDescriptionCache    = DEFAULT_EPG_DESCRIPTION_CACHE;
+int         g_iEPGHotWindow           = DEFAULT_EPG_HOT_WINDOW;
+int         g_iEPGMemoryBudget        = DEFAULT_EPG_MEMORY_BUDGET;
 std::string g_strUsername             = "";
 std::string g_strRecordingPath        = "";
 std::string g_strPassword             = "";
@@ -143,6 +147,22 @@ void ADDON_ReadSettings(void)
   if (!XBMC->GetSetting("updateint", &g_iUpdateInterval))
     g_iConnectTimeout = DEFAULT_UPDATE_INTERVAL;
 
+  /* read setting "requestcachettl" from settings.xml */
+  if (!XBMC->GetSetting("requestcachettl", &g_iRequestCacheTTL))
+    g_iRequestCacheTTL = DEFAULT_REQUEST_CACHE_TTL;
+
+  /* read setting "epgdescriptioncache" from settings.xml */
+  if (!XBMC->GetSetting("epgdescriptioncache", &g_iEPGDescriptionCache))
+    g_iEPGDescriptionCache = DEFAULT_EPG_DESCRIPTION_CACHE;
+
+  /* read setting "epghotwindow" from settings.xml */
+  if (!XBMC->GetSetting("epghotwindow", &g_iEPGHotWindow))
+    g_iEPGHotWindow = DEFAULT_EPG_HOT_WINDOW;
+
+  /* read setting "epgmemorybudget" from settings.xml */
+  if (!XBMC->GetSetting("epgmemorybudget", &g_iEPGMemoryBudget))
+    g_iEPGMemoryBudget = DEFAULT_EPG_MEMORY_BUDGET;
+
   /* read setting "iconpath" from settings.xml */
   if (XBMC->GetSetting("iconpath", buffer))
     g_strIconPath = buffer;
@@ -193,6 +213,22 @@ ADDON_STATUS ADDON_Create(void* hdl, void* props)
     return m_CurStatus;
   }
 
+  PVR_MENUHOOK hook;
+  hook.iHookId = MENUHOOK_RECORDING_DELETE_TITLE;
+  hook.iLocalizedStringId = 30030;
+  hook.category = PVR_MENUHOOK_RECORDING;
+  PVR->AddMenuHook(&hook);
+
+  hook.iHookId = MENUHOOK_TIMER_DELETE_TITLE;
+  hook.iLocalizedStringId = 30031;
+  hook.category = PVR_MENUHOOK_TIMER;
+  PVR->AddMenuHook(&hook);
+
+  hook.iHookId = MENUHOOK_MEMORY_USAGE;
+  hook.iLocalizedStringId = 30035;
+  hook.category = PVR_MENUHOOK_SETTING;
+  PVR->AddMenuHook(&hook);
+
   m_CurStatus = ADDON_STATUS_OK;
   m_bCreated = true;
   return m_CurStatus;
@@ -428,6 +464,14 @@ PVR_ERROR DeleteRecording(const PVR_RECORDING &recording)
   return VuData->DeleteRecording(recording);
 }
 
+PVR_ERROR CallMenuHook(const PVR_MENUHOOK &menuhook, const PVR_MENUHOOK_DATA &item)
+{
+  if (!VuData || !VuData->IsConnected())
+    return PVR_ERROR_SERVER_ERROR;
+
+  return VuData->CallMenuHook(menuhook, item);
+}
+
 PVR_ERROR RenameRecording(const PVR_RECORDING &recording)
 {
   return PVR_ERROR_NOT_IMPLEMENTED;
@@ -555,7 +599,6 @@ PVR_ERROR GetStreamProperties(PVR_STREAM_PROPERTIES* pProperties) { return PVR_E
 void DemuxAbort(void) { return; }
 DemuxPacket* DemuxRead(void) { return NULL; }
 PVR_ERROR OpenDialogChannelScan(void) { return PVR_ERROR_NOT_IMPLEMENTED; }
-PVR_ERROR CallMenuHook(const PVR_MENUHOOK &menuhook, const PVR_MENUHOOK_DATA &item) { return PVR_ERROR_NOT_IMPLEMENTED; }
 PVR_ERROR DeleteChannel(const PVR_CHANNEL &channel) { return PVR_ERROR_NOT_IMPLEMENTED; }
 PVR_ERROR RenameChannel(const PVR_CHANNEL &channel) { return PVR_ERROR_NOT_IMPLEMENTED; }
 PVR_ERROR MoveChannel(const PVR_CHANNEL &channel) { return PVR_ERROR_NOT_IMPLEMENTED; }
@@ -29,6 +29,10 @@
 #define DEFAULT_STREAM_PORT      8001 
 #define DEFAULT_WEB_PORT         80
 #define DEFAULT_UPDATE_INTERVAL  2
+#define DEFAULT_REQUEST_CACHE_TTL  2
+#define DEFAULT_EPG_DESCRIPTION_CACHE  0
+#define DEFAULT_EPG_HOT_WINDOW  0
+#define DEFAULT_EPG_MEMORY_BUDGET  0
 
 extern bool                      m_bCreated;
 extern std::string               g_strHostname;
@@ -39,6 +43,10 @@ extern std::string               g_strPassword;
 extern std::string               g_strIconPath;
 extern std::string               g_strRecordingPath;
 extern int 			 g_iUpdateInterval;
+extern int                       g_iRequestCacheTTL;
+extern int                       g_iEPGDescriptionCache;
+extern int                       g_iEPGHotWindow;
+extern int                       g_iEPGMemoryBudget;
 //extern int                       g_iClientId;
 extern unsigned int              g_iPacketSequence;
 extern bool                      g_bShowTimerNotifications;